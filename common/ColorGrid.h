@@ -0,0 +1,219 @@
+/******************************************************************************\
+| Grade de quadrados coloridos (linhas x colunas) desenhada numa única chamada |
+| instanciada, uma instância por célula. A cor de cada célula e se ela ainda   |
+| está no jogo ficam num buffer da GPU (RGBA8: rgb = cor, a = 0 se eliminada), |
+| lido no vertex shader por uma textura de buffer (texelFetch com o número da  |
+| instância). A posição vem de gl_InstanceID e o canto de gl_VertexID: não há  |
+| buffer de vértices nem uniform por célula.                                   |
+|                                                                              |
+| Mudar uma célula só altera a cópia na CPU e marca o trecho sujo; draw()      |
+| envia o trecho de uma vez (glBufferSubData), e um clique que muda uma célula |
+| envia 4 bytes. Células eliminadas viram um ponto fora da tela no vertex      |
+| shader e não geram fragmentos. O custo por quadro no driver não depende do   |
+| tamanho da grade.                                                            |
+|                                                                              |
+| Ids: linha * colunas + coluna, com a linha 0 em cima (y cresce para baixo    |
+| numa projeção como ortho(0, w, h, 0)).                                       |
+\******************************************************************************/
+#ifndef _COLOR_GRID_H_
+#define _COLOR_GRID_H_
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <vector>
+
+class ColorGrid {
+    GLuint vao, buffer, texture, shader;
+    GLint projectionLoc, originLoc, cellSizeLoc, colsLoc, cellsLoc;
+    int rows, cols;
+    float x, y, cellWidth, cellHeight;
+    std::vector<unsigned char> cells; // cópia do buffer, 4 bytes por célula
+    int dirtyFirst, dirtyLast;        // trecho ainda não enviado (first > last: nada)
+
+    static GLuint compile(GLenum type, const char *src) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::COLOR_GRID::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    void setupShader() {
+        // Cantos da strip: (0,0) (1,0) (0,1) (1,1)
+        const char *vertex_shader_src =
+            "#version 410 core\n"
+            "uniform samplerBuffer cells;\n"
+            "uniform mat4 projection;\n"
+            "uniform vec2 origin;\n"
+            "uniform vec2 cellSize;\n"
+            "uniform int cols;\n"
+            "out vec3 color;\n"
+            "void main() {\n"
+            "    vec4 cell = texelFetch(cells, gl_InstanceID);\n"
+            "    color = cell.rgb;\n"
+            "    if (cell.a == 0.0) {\n"
+            "        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n" // fora do volume de recorte
+            "        return;\n"
+            "    }\n"
+            "    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+            "    vec2 index = vec2(gl_InstanceID % cols, gl_InstanceID / cols);\n"
+            "    gl_Position = projection * vec4(origin + (index + corner) * cellSize, 0.0, 1.0);\n"
+            "}\n";
+
+        const char *fragment_shader_src =
+            "#version 410 core\n"
+            "in vec3 color;\n"
+            "out vec4 FragColor;\n"
+            "void main() {\n"
+            "    FragColor = vec4(color, 1.0);\n"
+            "}\n";
+
+        GLuint vs = compile(GL_VERTEX_SHADER, vertex_shader_src);
+        GLuint fs = compile(GL_FRAGMENT_SHADER, fragment_shader_src);
+        this->shader = glCreateProgram();
+        glAttachShader(this->shader, vs);
+        glAttachShader(this->shader, fs);
+        glLinkProgram(this->shader);
+        GLint success;
+        glGetProgramiv(this->shader, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(this->shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::COLOR_GRID::LINKING_FAILED\n" << infoLog << std::endl;
+        }
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        this->projectionLoc = glGetUniformLocation(this->shader, "projection");
+        this->originLoc = glGetUniformLocation(this->shader, "origin");
+        this->cellSizeLoc = glGetUniformLocation(this->shader, "cellSize");
+        this->colsLoc = glGetUniformLocation(this->shader, "cols");
+        this->cellsLoc = glGetUniformLocation(this->shader, "cells");
+    }
+
+    void touch(int id) {
+        if (id < this->dirtyFirst)
+            this->dirtyFirst = id;
+        if (id > this->dirtyLast)
+            this->dirtyLast = id;
+    }
+
+    static unsigned char byte(float c) {
+        return (unsigned char)(c <= 0.0f ? 0 : (c >= 1.0f ? 255 : c * 255.0f + 0.5f));
+    }
+
+public:
+    ColorGrid() {
+        this->vao = this->buffer = this->texture = this->shader = 0;
+        this->rows = this->cols = 0;
+        this->x = this->y = this->cellWidth = this->cellHeight = 0.0f;
+        this->dirtyFirst = 0;
+        this->dirtyLast = -1;
+    }
+
+    // Precisa do contexto ainda ativo
+    ~ColorGrid() {
+        if (!this->vao)
+            return;
+        glDeleteTextures(1, &this->texture);
+        glDeleteBuffers(1, &this->buffer);
+        glDeleteVertexArrays(1, &this->vao);
+        glDeleteProgram(this->shader);
+    }
+
+    // Cria a grade, com todas as células pretas e no jogo, com o canto de
+    // cima à esquerda em (x, y); precisa de um contexto GL ativo. false se a
+    // grade passa de GL_MAX_TEXTURE_BUFFER_SIZE células.
+    bool init(int rows, int cols, float cellWidth, float cellHeight, float x = 0.0f, float y = 0.0f) {
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if (rows <= 0 || cols <= 0 || (long long)rows * cols > maxTexels)
+            return false;
+        if (!this->vao) {
+            this->setupShader();
+            glGenVertexArrays(1, &this->vao);
+            glGenBuffers(1, &this->buffer);
+            glGenTextures(1, &this->texture);
+        }
+        this->rows = rows;
+        this->cols = cols;
+        this->cellWidth = cellWidth;
+        this->cellHeight = cellHeight;
+        this->x = x;
+        this->y = y;
+        this->cells.assign((size_t)rows * cols * 4, 0);
+        for (size_t i = 3; i < this->cells.size(); i += 4)
+            this->cells[i] = 255;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, this->buffer);
+        glBufferData(GL_TEXTURE_BUFFER, this->cells.size(), this->cells.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA8, this->buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        this->dirtyFirst = this->getCells();
+        this->dirtyLast = -1;
+        return true;
+    }
+
+    int getCells() const {
+        return this->rows * this->cols;
+    }
+
+    // Muda a cor e põe a célula de volta no jogo
+    void setColor(int id, float r, float g, float b) {
+        unsigned char *c = &this->cells[id * 4];
+        c[0] = byte(r);
+        c[1] = byte(g);
+        c[2] = byte(b);
+        c[3] = 255;
+        this->touch(id);
+    }
+
+    void eliminate(int id) {
+        if (!this->cells[id * 4 + 3])
+            return;
+        this->cells[id * 4 + 3] = 0;
+        this->touch(id);
+    }
+
+    bool isEliminated(int id) const {
+        return !this->cells[id * 4 + 3];
+    }
+
+    // Envia as células alteradas e desenha a grade com a projeção dada
+    // (mat4, coluna a coluna). Deixa o programa da grade em uso.
+    void draw(const float *projection) {
+        if (!this->vao)
+            return;
+        if (this->dirtyFirst <= this->dirtyLast) {
+            glBindBuffer(GL_TEXTURE_BUFFER, this->buffer);
+            glBufferSubData(GL_TEXTURE_BUFFER, this->dirtyFirst * 4, (this->dirtyLast - this->dirtyFirst + 1) * 4,
+                            &this->cells[this->dirtyFirst * 4]);
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            this->dirtyFirst = this->getCells();
+            this->dirtyLast = -1;
+        }
+        glUseProgram(this->shader);
+        glUniformMatrix4fv(this->projectionLoc, 1, GL_FALSE, projection);
+        glUniform2f(this->originLoc, this->x, this->y);
+        glUniform2f(this->cellSizeLoc, this->cellWidth, this->cellHeight);
+        glUniform1i(this->colsLoc, this->cols);
+        glUniform1i(this->cellsLoc, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+        glBindVertexArray(this->vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, this->getCells());
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+/******************************************************************************\
+| Índice de cores para buscas por raio ("todas as cores a até d desta").       |
+| O cubo RGB [0, 1]^3 é dividido numa grade uniforme de baldes, cada um com    |
+| as cores (e ids) que caem nele. Uma busca só olha os baldes que a esfera     |
+| alcança: os que ficam inteiros dentro dela são levados sem calcular          |
+| distância, e só nos da borda cada cor é testada.                             |
+|                                                                              |
+| As cores saem do índice quando são encontradas (removeWithin) ou removidas   |
+| (remove), com troca pelo último do balde: ele só guarda as cores vivas, e    |
+| ao longo de uma partida cada cor é testada poucas vezes, não uma vez por     |
+| busca como numa varredura da grade toda.                                     |
+|                                                                              |
+| O lado do balde é metade do raio dado no construtor (o raio das buscas       |
+| mais comuns); buscas com outro raio também funcionam. As cores precisam      |
+| estar em [0, 1]. Ids são inteiros >= 0 escolhidos por quem usa (p. ex.       |
+| linha * colunas + coluna).                                                   |
+\******************************************************************************/
+#ifndef _COLOR_INDEX_H_
+#define _COLOR_INDEX_H_
+
+#include <cmath>
+#include <vector>
+
+class ColorIndex {
+    struct Entry {
+        float r, g, b;
+        int id;
+    };
+
+    int n;          // baldes por eixo
+    float side;     // lado de um balde
+    std::vector<std::vector<Entry>> buckets;
+    std::vector<int> bucketOf, slotOf; // por id: balde e posição nele (-1 fora do índice)
+    int live;
+
+    int axis(float c) const {
+        int k = (int)(c / this->side);
+        return k < 0 ? 0 : (k >= this->n ? this->n - 1 : k);
+    }
+
+    // Menor e maior distância ao quadrado de c até o intervalo do balde k
+    void span(float c, int k, float &near2, float &far2) const {
+        float lo = k * this->side, hi = lo + this->side;
+        float dn = c < lo ? lo - c : (c > hi ? c - hi : 0.0f);
+        float df = c - lo > hi - c ? c - lo : hi - c;
+        near2 = dn * dn;
+        far2 = df * df;
+    }
+
+public:
+    ColorIndex(float radius) {
+        this->n = (int)std::ceil(2.0f / radius);
+        this->n = this->n < 1 ? 1 : (this->n > 64 ? 64 : this->n);
+        this->side = 1.0f / this->n;
+        this->buckets.resize(this->n * this->n * this->n);
+        this->live = 0;
+    }
+
+    // Esvazia o índice (os baldes mantêm a memória para o próximo uso)
+    void clear() {
+        for (size_t i = 0; i < this->buckets.size(); i++)
+            this->buckets[i].clear();
+        this->bucketOf.assign(this->bucketOf.size(), -1);
+        this->live = 0;
+    }
+
+    void insert(int id, float r, float g, float b) {
+        if (id >= (int)this->bucketOf.size()) {
+            this->bucketOf.resize(id + 1, -1);
+            this->slotOf.resize(id + 1, -1);
+        }
+        if (this->bucketOf[id] >= 0)
+            this->remove(id);
+        int k = (this->axis(r) * this->n + this->axis(g)) * this->n + this->axis(b);
+        Entry e = {r, g, b, id};
+        this->bucketOf[id] = k;
+        this->slotOf[id] = (int)this->buckets[k].size();
+        this->buckets[k].push_back(e);
+        this->live++;
+    }
+
+    bool contains(int id) const {
+        return id >= 0 && id < (int)this->bucketOf.size() && this->bucketOf[id] >= 0;
+    }
+
+    void remove(int id) {
+        if (!this->contains(id))
+            return;
+        std::vector<Entry> &v = this->buckets[this->bucketOf[id]];
+        int s = this->slotOf[id];
+        v[s] = v.back();
+        this->slotOf[v[s].id] = s;
+        v.pop_back();
+        this->bucketOf[id] = -1;
+        this->live--;
+    }
+
+    // Cores ainda no índice
+    int size() const {
+        return this->live;
+    }
+
+    // Tira do índice todas as cores a distância <= radius de (r, g, b) e
+    // acrescenta os ids delas em found. Devolve quantas foram.
+    int removeWithin(float r, float g, float b, float radius, std::vector<int> &found) {
+        float r2 = radius * radius;
+        int lo[3] = {this->axis(r - radius), this->axis(g - radius), this->axis(b - radius)};
+        int hi[3] = {this->axis(r + radius), this->axis(g + radius), this->axis(b + radius)};
+        int removed = 0;
+        for (int i = lo[0]; i <= hi[0]; i++) {
+            float nr, fr;
+            this->span(r, i, nr, fr);
+            for (int j = lo[1]; j <= hi[1]; j++) {
+                float ng, fg;
+                this->span(g, j, ng, fg);
+                for (int k = lo[2]; k <= hi[2]; k++) {
+                    float nb, fb;
+                    this->span(b, k, nb, fb);
+                    if (nr + ng + nb > r2)
+                        continue;
+                    std::vector<Entry> &v = this->buckets[(i * this->n + j) * this->n + k];
+                    if (fr + fg + fb <= r2) {
+                        // o balde inteiro está dentro da esfera
+                        for (size_t s = 0; s < v.size(); s++) {
+                            found.push_back(v[s].id);
+                            this->bucketOf[v[s].id] = -1;
+                        }
+                        removed += (int)v.size();
+                        v.clear();
+                        continue;
+                    }
+                    for (size_t s = v.size(); s-- > 0;) {
+                        float dr = v[s].r - r, dg = v[s].g - g, db = v[s].b - b;
+                        if (dr * dr + dg * dg + db * db > r2)
+                            continue;
+                        found.push_back(v[s].id);
+                        this->bucketOf[v[s].id] = -1;
+                        v[s] = v.back();
+                        this->slotOf[v[s].id] = (int)s;
+                        v.pop_back();
+                        removed++;
+                    }
+                }
+            }
+        }
+        this->live -= removed;
+        return removed;
+    }
+};
+
+#endif
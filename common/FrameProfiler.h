@@ -0,0 +1,294 @@
+/******************************************************************************\
+| Perfil por quadro: para onde vai o tempo de cada quadro, na CPU e na GPU.    |
+| Zonas com nome são marcadas por escopo (ProfileZone, RAII) e podem ser       |
+| aninhadas; as marcadas com gpu = true também ganham uma consulta             |
+| GL_TIME_ELAPSED. Há dois conjuntos de consultas, um para os quadros pares e  |
+| outro para os ímpares: o resultado do quadro N é lido no início do quadro    |
+| N + 2, quando a GPU em geral já terminou, e só se GL_QUERY_RESULT_AVAILABLE  |
+| diz que está pronto. A leitura nunca espera; se ainda não chegou, a medida   |
+| de GPU daquela zona é perdida (e contada em getGpuLost()).                   |
+|                                                                              |
+| Os últimos quadros ficam num buffer circular de tamanho fixo (sem alocação   |
+| durante o jogo). report() mostra a média por zona e writeChromeTrace() grava |
+| o JSON do formato "Trace Event" (chrome://tracing, ui.perfetto.dev).         |
+|                                                                              |
+| Uso:                                                                         |
+|   FrameProfiler perfil;                                                      |
+|   perfil.beginFrame();                                                       |
+|   { ProfileZone zona(perfil, "mapa", true); desenharMapa(); }                |
+|   perfil.endFrame();                                                         |
+|                                                                              |
+| Consultas GL_TIME_ELAPSED não podem se sobrepor: dentro de uma zona de GPU,  |
+| as zonas aninhadas só medem CPU, e setGpuEnabled(false) desliga todas (p.    |
+| ex. quando o quadro inteiro já é medido por HeadlessRun). Os nomes das zonas |
+| são guardados como ponteiro: use literais. O destrutor precisa do contexto.  |
+\******************************************************************************/
+#ifndef _FRAME_PROFILER_H_
+#define _FRAME_PROFILER_H_
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define PROFILER_MAX_SAMPLES 64 // zonas por quadro; as que passarem disso não são medidas
+
+struct ProfileSample {
+    const char *name;
+    int depth;              // 0: zona de fora
+    double startUs, cpuUs;  // microssegundos desde a criação do perfil
+    double gpuUs;           // < 0: sem medida de GPU
+    bool gpuPending;        // consulta feita, resultado ainda não lido
+};
+
+struct ProfileFrame {
+    long long index;
+    double startUs, cpuUs;
+    int count;
+    ProfileSample samples[PROFILER_MAX_SAMPLES];
+};
+
+class FrameProfiler {
+    std::vector<ProfileFrame> frames;   // buffer circular: quadro n em n % frames.size()
+    long long frame;                    // quadro atual (-1 antes do primeiro)
+    bool inFrame;
+    int depth;
+    int gpuOpen;                        // amostra com a consulta de GPU aberta, ou -1
+    bool gpuEnabled;
+    GLuint queries[2][PROFILER_MAX_SAMPLES]; // [quadro % 2][amostra], criadas no primeiro uso
+    bool hasQueries;
+    long long gpuLost;
+    std::chrono::steady_clock::time_point origin;
+
+    double now() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - this->origin).count();
+    }
+
+    ProfileFrame &record(long long n) {
+        return this->frames[n % this->frames.size()];
+    }
+
+    // Se n ainda está no buffer (e já começou)
+    bool stored(long long n) const {
+        return n >= 0 && n <= this->frame && n > this->frame - (long long)this->frames.size();
+    }
+
+    // Lê as consultas de GPU do quadro n. Sem wait, só as que já estão
+    // prontas; as outras são perdidas, porque o conjunto vai ser reusado.
+    void collect(long long n, bool wait) {
+        if (!this->stored(n))
+            return;
+        ProfileFrame &f = this->record(n);
+        for (int i = 0; i < f.count; i++) {
+            ProfileSample &s = f.samples[i];
+            if (!s.gpuPending)
+                continue;
+            s.gpuPending = false;
+            GLuint query = this->queries[n % 2][i];
+            GLuint available = GL_TRUE;
+            if (!wait)
+                glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+                s.gpuUs = ns / 1000.0;
+            } else {
+                this->gpuLost++;
+            }
+        }
+    }
+
+public:
+    // Guarda os últimos `capacity` quadros (pelo menos 3: a GPU chega 2 depois)
+    FrameProfiler(int capacity = 600) {
+        this->frames.resize(capacity < 3 ? 3 : capacity);
+        this->frame = -1;
+        this->inFrame = false;
+        this->depth = 0;
+        this->gpuOpen = -1;
+        this->gpuEnabled = true;
+        this->hasQueries = false;
+        this->gpuLost = 0;
+        this->origin = std::chrono::steady_clock::now();
+    }
+
+    ~FrameProfiler() {
+        if (this->hasQueries)
+            glDeleteQueries(2 * PROFILER_MAX_SAMPLES, &this->queries[0][0]);
+    }
+
+    void setGpuEnabled(bool enabled) {
+        this->gpuEnabled = enabled;
+    }
+
+    long long getGpuLost() const {
+        return this->gpuLost;
+    }
+
+    void beginFrame() {
+        this->frame++;
+        this->inFrame = true;
+        this->depth = 0;
+        this->gpuOpen = -1;
+        // o conjunto de consultas deste quadro foi usado 2 quadros atrás
+        this->collect(this->frame - 2, false);
+        ProfileFrame &f = this->record(this->frame);
+        f.index = this->frame;
+        f.count = 0;
+        f.cpuUs = 0.0;
+        f.startUs = this->now();
+    }
+
+    void endFrame() {
+        if (!this->inFrame)
+            return;
+        ProfileFrame &f = this->record(this->frame);
+        f.cpuUs = this->now() - f.startUs;
+        this->inFrame = false;
+    }
+
+    // Abre uma zona; devolve o índice da amostra para endZone (-1: não medida)
+    int beginZone(const char *name, bool gpu = false) {
+        if (!this->inFrame)
+            return -1;
+        ProfileFrame &f = this->record(this->frame);
+        if (f.count == PROFILER_MAX_SAMPLES)
+            return -1;
+        int i = f.count++;
+        ProfileSample &s = f.samples[i];
+        s.name = name;
+        s.depth = this->depth++;
+        s.cpuUs = 0.0;
+        s.gpuUs = -1.0;
+        s.gpuPending = false;
+        if (gpu && this->gpuEnabled && this->gpuOpen < 0) {
+            if (!this->hasQueries) {
+                glGenQueries(2 * PROFILER_MAX_SAMPLES, &this->queries[0][0]);
+                this->hasQueries = true;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, this->queries[this->frame % 2][i]);
+            s.gpuPending = true;
+            this->gpuOpen = i;
+        }
+        s.startUs = this->now();
+        return i;
+    }
+
+    void endZone(int i) {
+        if (i < 0 || !this->inFrame)
+            return;
+        ProfileSample &s = this->record(this->frame).samples[i];
+        s.cpuUs = this->now() - s.startUs;
+        this->depth--;
+        if (this->gpuOpen == i) {
+            glEndQuery(GL_TIME_ELAPSED);
+            this->gpuOpen = -1;
+        }
+    }
+
+    // Média por quadro de cada zona (somando as repetições no mesmo quadro)
+    // nos últimos `count` quadros com GPU já lida
+    void report(int count) {
+        long long last = this->frame - 2, first = last - count + 1;
+        while (!this->stored(first) && first <= last)
+            first++;
+        if (first > last)
+            return;
+        int n = (int)(last - first + 1);
+
+        const char *names[PROFILER_MAX_SAMPLES];
+        double cpu[PROFILER_MAX_SAMPLES], gpu[PROFILER_MAX_SAMPLES];
+        int samples[PROFILER_MAX_SAMPLES], measured[PROFILER_MAX_SAMPLES];
+        int zones = 0;
+        double frameCpu = 0.0;
+        for (long long q = first; q <= last; q++) {
+            ProfileFrame &f = this->record(q);
+            frameCpu += f.cpuUs;
+            for (int i = 0; i < f.count; i++) {
+                ProfileSample &s = f.samples[i];
+                int z = 0;
+                while (z < zones && strcmp(names[z], s.name) != 0)
+                    z++;
+                if (z == zones) {
+                    if (zones == PROFILER_MAX_SAMPLES)
+                        continue;
+                    names[z] = s.name;
+                    cpu[z] = gpu[z] = 0.0;
+                    samples[z] = measured[z] = 0;
+                    zones++;
+                }
+                cpu[z] += s.cpuUs;
+                samples[z]++;
+                if (s.gpuUs >= 0.0) {
+                    gpu[z] += s.gpuUs;
+                    measured[z]++;
+                }
+            }
+        }
+        printf("Perfil (%d quadros, ms por quadro): quadro %.3f na CPU\n", n, frameCpu / n / 1000.0);
+        for (int z = 0; z < zones; z++) {
+            printf("  %-12s CPU %7.3f", names[z], cpu[z] / n / 1000.0);
+            // medidas perdidas contam pela média das outras
+            if (measured[z])
+                printf("   GPU %7.3f", gpu[z] * samples[z] / measured[z] / n / 1000.0);
+            printf("\n");
+        }
+        if (this->gpuLost)
+            printf("  (%lld medidas de GPU chegaram tarde e foram perdidas)\n", this->gpuLost);
+    }
+
+    // Grava os quadros do buffer no formato Trace Event. Lê (esperando) as
+    // consultas que faltam: chamar no fim, com o contexto ainda ativo.
+    // As zonas de GPU vão numa linha própria, alinhadas ao início da zona na
+    // CPU: o GL_TIME_ELAPSED dá a duração, não o momento em que a GPU rodou.
+    bool writeChromeTrace(const std::string &path) {
+        if (this->inFrame)
+            this->endFrame();
+        this->collect(this->frame - 1, true);
+        this->collect(this->frame, true);
+
+        FILE *out = fopen(path.c_str(), "w");
+        if (!out)
+            return false;
+        fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+        fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+        long long first = this->frame - (long long)this->frames.size() + 1;
+        for (long long q = first < 0 ? 0 : first; q <= this->frame; q++) {
+            ProfileFrame &f = this->record(q);
+            fprintf(out, ",\n{\"name\":\"quadro\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                         "\"args\":{\"quadro\":%lld}}",
+                    f.startUs, f.cpuUs, f.index);
+            for (int i = 0; i < f.count; i++) {
+                ProfileSample &s = f.samples[i];
+                fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", s.name,
+                        s.startUs, s.cpuUs);
+                if (s.gpuUs >= 0.0)
+                    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+                            s.name, s.startUs, s.gpuUs);
+            }
+        }
+        fprintf(out, "\n]}\n");
+        return fclose(out) == 0;
+    }
+};
+
+// Zona do escopo atual: mede do construtor ao destrutor
+class ProfileZone {
+    FrameProfiler &profiler;
+    int sample;
+
+public:
+    ProfileZone(FrameProfiler &profiler, const char *name, bool gpu = false) : profiler(profiler) {
+        this->sample = profiler.beginZone(name, gpu);
+    }
+
+    ~ProfileZone() {
+        this->profiler.endZone(this->sample);
+    }
+};
+
+#endif
@@ -0,0 +1,289 @@
+/******************************************************************************\
+| Modo sem janela visível, para medir tempo de quadro em máquinas de build.    |
+| A janela GLFW é criada invisível (ou, sem servidor gráfico, na plataforma    |
+| "null" do GLFW 3.4 com contexto OSMesa, renderizado pelo llvmpipe do Mesa) e |
+| o programa desenha um número fixo de quadros num framebuffer próprio (FBO).  |
+| Para cada quadro são guardados o tempo de CPU e o de GPU (GL_TIME_ELAPSED);  |
+| no fim sai um CSV "quadro,cpu_ms,gpu_ms" e um resumo. Opcionalmente grava o  |
+| FBO em PNG: só se stb_image_write.h for incluído antes deste arquivo.        |
+|                                                                              |
+| Argumentos aceitos por parseArgs:                                            |
+|   --headless N        desenha N quadros sem janela e sai                       |
+|   --timings arq.csv   onde gravar os tempos (padrão: só o resumo no console) |
+|   --capture prefixo   grava prefixo_<quadro>.png                             |
+|   --capture-every K   um PNG a cada K quadros (padrão: só o último)          |
+\******************************************************************************/
+#ifndef _HEADLESS_H_
+#define _HEADLESS_H_
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct HeadlessOptions {
+    bool enabled;
+    int frames;
+    std::string timingsPath;
+    std::string capturePrefix;
+    int captureEvery;       // 0: só o último quadro
+
+    HeadlessOptions() {
+        this->enabled = false;
+        this->frames = 0;
+        this->captureEvery = 0;
+    }
+
+    // false se algum argumento estiver incompleto ou for desconhecido
+    bool parseArgs(int argc, char **argv) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--headless" && hasValue) {
+                this->enabled = true;
+                this->frames = atoi(argv[++i]);
+            } else if (arg == "--timings" && hasValue) {
+                this->timingsPath = argv[++i];
+            } else if (arg == "--capture" && hasValue) {
+                this->capturePrefix = argv[++i];
+            } else if (arg == "--capture-every" && hasValue) {
+                this->captureEvery = atoi(argv[++i]);
+            } else {
+                fprintf(stderr, "Argumento inválido: %s\n", argv[i]);
+                return false;
+            }
+        }
+        if (this->enabled && this->frames <= 0) {
+            fprintf(stderr, "--headless precisa de um número de quadros\n");
+            return false;
+        }
+#ifndef INCLUDE_STB_IMAGE_WRITE_H
+        if (!this->capturePrefix.empty()) {
+            fprintf(stderr, "--capture: programa compilado sem stb_image_write.h\n");
+            return false;
+        }
+#endif
+        return true;
+    }
+};
+
+// glfwInit para o modo sem janela: se não houver servidor gráfico, tenta a
+// plataforma "null" do GLFW com contexto OSMesa. Depois, glfwCreateWindow
+// cria uma janela invisível.
+inline bool glfwInitHeadless() {
+    if (glfwInit()) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        return true;
+    }
+#ifdef GLFW_PLATFORM_NULL
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (glfwInit()) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        return true;
+    }
+#endif
+    return false;
+}
+
+// Alvo de desenho fora da tela: cor RGBA8 + profundidade, do tamanho pedido
+class OffscreenTarget {
+    GLuint fbo, color, depth;
+    int width, height;
+
+public:
+    OffscreenTarget() {
+        this->fbo = this->color = this->depth = 0;
+        this->width = this->height = 0;
+    }
+
+    ~OffscreenTarget() {
+        destroy();
+    }
+
+    bool create(int w, int h) {
+        destroy();
+        this->width = w;
+        this->height = h;
+        glGenRenderbuffers(1, &this->color);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        glGenRenderbuffers(1, &this->depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &this->fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->depth);
+        bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return ok;
+    }
+
+    void destroy() {
+        if (this->fbo)
+            glDeleteFramebuffers(1, &this->fbo);
+        if (this->color)
+            glDeleteRenderbuffers(1, &this->color);
+        if (this->depth)
+            glDeleteRenderbuffers(1, &this->depth);
+        this->fbo = this->color = this->depth = 0;
+    }
+
+    // Passa a desenhar no FBO, com a viewport do tamanho dele
+    void bind() {
+        glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+        glViewport(0, 0, this->width, this->height);
+    }
+
+#ifdef INCLUDE_STB_IMAGE_WRITE_H
+    // Grava a cor em PNG, com a primeira linha do arquivo no topo da imagem
+    bool savePng(const std::string &path) {
+        std::vector<unsigned char> rgba((size_t)this->width * this->height * 4);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, this->width, this->height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        int stride = this->width * 4;
+        return stbi_write_png(path.c_str(), this->width, this->height, 4,
+                              rgba.data() + (size_t)(this->height - 1) * stride, -stride) != 0;
+    }
+#endif
+
+    int getWidth() const {
+        return this->width;
+    }
+
+    int getHeight() const {
+        return this->height;
+    }
+};
+
+// Roda os quadros do modo sem janela: beginFrame() / endFrame() em volta do
+// desenho de cada quadro, done() diz quando parar e finish() grava os tempos.
+// As consultas de GPU só são lidas em finish(), para não esperar a GPU no meio.
+class HeadlessRun {
+    HeadlessOptions options;
+    OffscreenTarget target;
+    std::vector<GLuint> queries;    // uma por quadro
+    std::vector<double> cpuMs;
+    std::chrono::steady_clock::time_point frameStart;
+    int frame;
+
+public:
+    HeadlessRun(const HeadlessOptions &options) {
+        this->options = options;
+        this->frame = 0;
+    }
+
+    ~HeadlessRun() {
+        if (!this->queries.empty())
+            glDeleteQueries((GLsizei)this->queries.size(), this->queries.data());
+    }
+
+    bool start(int width, int height) {
+        if (!this->target.create(width, height)) {
+            fprintf(stderr, "Headless: FBO %dx%d incompleto\n", width, height);
+            return false;
+        }
+        this->queries.resize(this->options.frames);
+        glGenQueries(this->options.frames, this->queries.data());
+
+        // Primeiro uso do FBO fora da medição (no llvmpipe, o primeiro
+        // GL_TIME_ELAPSED sobre um FBO novo volta com lixo)
+        this->target.bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glFinish();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        this->cpuMs.reserve(this->options.frames);
+        return true;
+    }
+
+    bool done() const {
+        return this->frame >= this->options.frames;
+    }
+
+    int getFrame() const {
+        return this->frame;
+    }
+
+    void beginFrame() {
+        this->frameStart = std::chrono::steady_clock::now();
+        this->target.bind();
+        glBeginQuery(GL_TIME_ELAPSED, this->queries[this->frame]);
+    }
+
+    // O tempo de CPU inclui o glFinish: sem a troca de buffers da janela, é ele
+    // que impede a CPU de ir muito à frente da GPU
+    void endFrame() {
+        glEndQuery(GL_TIME_ELAPSED);
+        glFinish();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - this->frameStart;
+        this->cpuMs.push_back(elapsed.count());
+
+#ifdef INCLUDE_STB_IMAGE_WRITE_H
+        bool last = this->frame == this->options.frames - 1;
+        int every = this->options.captureEvery;
+        if (!this->options.capturePrefix.empty() && (last || (every > 0 && this->frame % every == 0))) {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%04d.png", this->frame);
+            if (!this->target.savePng(this->options.capturePrefix + suffix))
+                fprintf(stderr, "Headless: falha ao gravar %s%s\n", this->options.capturePrefix.c_str(), suffix);
+        }
+#endif
+        this->frame++;
+    }
+
+    // Lê os tempos de GPU, grava o CSV (se pedido) e mostra média, p50, p95 e máximo
+    bool finish() {
+        int n = this->frame;
+        std::vector<double> gpuMs(n);
+        for (int i = 0; i < n; i++) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(this->queries[i], GL_QUERY_RESULT, &ns);
+            gpuMs[i] = ns / 1.0e6;
+        }
+
+        bool ok = true;
+        if (!this->options.timingsPath.empty()) {
+            FILE *out = fopen(this->options.timingsPath.c_str(), "w");
+            if (out) {
+                fprintf(out, "quadro,cpu_ms,gpu_ms\n");
+                for (int i = 0; i < n; i++)
+                    fprintf(out, "%d,%.4f,%.4f\n", i, this->cpuMs[i], gpuMs[i]);
+                ok = fclose(out) == 0;
+            } else {
+                ok = false;
+            }
+            if (!ok)
+                fprintf(stderr, "Headless: falha ao gravar %s\n", this->options.timingsPath.c_str());
+        }
+
+        printf("Headless: %d quadros de %dx%d (%s)\n", n, this->target.getWidth(), this->target.getHeight(),
+               (const char *)glGetString(GL_RENDERER));
+        summary("CPU", this->cpuMs);
+        summary("GPU", gpuMs);
+        return ok;
+    }
+
+    static void summary(const char *name, std::vector<double> ms) {
+        if (ms.empty())
+            return;
+        double total = 0.0;
+        for (size_t i = 0; i < ms.size(); i++)
+            total += ms[i];
+        std::sort(ms.begin(), ms.end());
+        printf("  %s ms/quadro: média %.3f  p50 %.3f  p95 %.3f  máx %.3f\n", name, total / ms.size(),
+               ms[ms.size() / 2], ms[ms.size() * 95 / 100], ms.back());
+    }
+};
+
+#endif
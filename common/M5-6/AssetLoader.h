@@ -0,0 +1,273 @@
+//
+//  AssetLoader.h
+//
+//  Carrega PNGs em segundo plano: um grupo de threads decodifica as imagens
+//  (stbi_load) e a thread do OpenGL só recebe os pixels prontos. Quem pede
+//  escolhe o que quer de volta:
+//   - loadPixels(): os pixels RGBA, para quem vai montar algo na CPU (p. ex.
+//     TextureAtlas::add);
+//   - loadTexture(): uma textura já criada. O envio para a GPU passa por um
+//     pixel buffer object (PBO), em faixas de linhas, e cada update() só envia
+//     o que cabe no orçamento de tempo do quadro.
+//
+//  Os callbacks rodam sempre dentro de update(), na thread do OpenGL. Em caso
+//  de falha eles recebem NULL / textura 0 e w = h = 0.
+//
+//  Uso típico: os pedidos podem ser feitos antes de haver contexto OpenGL; a
+//  cada quadro, update(ms). O destrutor precisa do contexto ainda ativo (apaga
+//  o PBO) e espera as threads terminarem a imagem que estão decodificando.
+//
+//  Precisa de stb_image.h (STB_IMAGE_IMPLEMENTATION em algum .cpp) e de
+//  Threads no CMake.
+//
+
+#ifndef AssetLoader_h
+#define AssetLoader_h
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ASSET_LOADER_STRIP_BYTES (1 << 20) // máximo enviado por glTexSubImage2D
+
+// (std::min) e (std::max) entre parênteses: o windows.h define min e max como macros
+
+class AssetLoader {
+public:
+    typedef std::function<void(const unsigned char *rgba, int w, int h)> PixelsCallback;
+    typedef std::function<void(GLuint texture, int w, int h)> TextureCallback;
+
+private:
+    struct Job {
+        std::string path;
+        bool texture;               // loadTexture (senão loadPixels)
+        GLint filter;
+        PixelsCallback onPixels;
+        TextureCallback onTexture;
+        unsigned char *rgba;        // preenchido pela thread (NULL se falhou)
+        int w, h;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable hasWork;
+    std::deque<Job> queued;         // esperando uma thread
+    std::deque<Job> decoded;        // esperando update()
+    bool stopping;
+    int pending;                    // pedidos ainda não entregues
+
+    // Textura sendo enviada (só na thread do OpenGL)
+    Job uploading;
+    bool isUploading;
+    GLuint uploadTex;
+    int uploadRow;
+    GLuint pbo;
+
+    void work() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->hasWork.wait(lock, [this] { return this->stopping || !this->queued.empty(); });
+                if (this->stopping)
+                    return;
+                job = this->queued.front();
+                this->queued.pop_front();
+            }
+            int n;
+            job.rgba = stbi_load(job.path.c_str(), &job.w, &job.h, &n, 4);
+            if (!job.rgba)
+                job.w = job.h = 0;
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->decoded.push_back(job);
+        }
+    }
+
+    void request(Job &job) {
+        job.rgba = NULL;
+        job.w = job.h = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->queued.push_back(job);
+            this->pending++;
+        }
+        this->hasWork.notify_one();
+    }
+
+    void finish(Job &job, GLuint texture) {
+        if (!job.rgba)
+            std::cerr << "AssetLoader: falha ao carregar " << job.path << std::endl;
+        if (job.texture)
+            job.onTexture(texture, job.w, job.h);
+        else
+            job.onPixels(job.rgba, job.w, job.h);
+        if (job.rgba)
+            stbi_image_free(job.rgba);
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending--;
+    }
+
+    // Cria a textura vazia; as linhas chegam depois, por uploadStrip()
+    void beginUpload(Job &job) {
+        this->uploading = job;
+        this->isUploading = true;
+        this->uploadRow = 0;
+        glGenTextures(1, &this->uploadTex);
+        glBindTexture(GL_TEXTURE_2D, this->uploadTex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job.filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, job.filter);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, job.w, job.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    // Copia uma faixa de linhas para o PBO e manda a GPU ler de lá. O glBufferData
+    // com NULL descarta o conteúdo anterior, então não espera a faixa anterior.
+    void uploadStrip() {
+        Job &job = this->uploading;
+        int rowBytes = job.w * 4;
+        int rows = (std::max)(1, ASSET_LOADER_STRIP_BYTES / rowBytes);
+        rows = (std::min)(rows, job.h - this->uploadRow);
+        size_t bytes = (size_t)rows * rowBytes;
+
+        if (!this->pbo)
+            glGenBuffers(1, &this->pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (dst) {
+            memcpy(dst, job.rgba + (size_t)this->uploadRow * rowBytes, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindTexture(GL_TEXTURE_2D, this->uploadTex);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, this->uploadRow, job.w, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const void *)0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else { // sem PBO: envia direto da memória
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glBindTexture(GL_TEXTURE_2D, this->uploadTex);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, this->uploadRow, job.w, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                            job.rgba + (size_t)this->uploadRow * rowBytes);
+        }
+
+        this->uploadRow += rows;
+        if (this->uploadRow == job.h) {
+            this->isUploading = false;
+            finish(job, this->uploadTex);
+        }
+    }
+
+public:
+    // nThreads <= 0: um a menos que o número de núcleos (pelo menos 1)
+    AssetLoader(int nThreads = 0) {
+        this->stopping = false;
+        this->pending = 0;
+        this->isUploading = false;
+        this->uploadTex = 0;
+        this->uploadRow = 0;
+        this->pbo = 0;
+        if (nThreads <= 0)
+            nThreads = (std::max)(1, (int)std::thread::hardware_concurrency() - 1);
+        for (int i = 0; i < nThreads; i++)
+            this->workers.push_back(std::thread(&AssetLoader::work, this));
+    }
+
+    // Pedidos não entregues são descartados (sem callback)
+    ~AssetLoader() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->hasWork.notify_all();
+        for (std::thread &t : this->workers)
+            t.join();
+        for (Job &job : this->decoded)
+            if (job.rgba)
+                stbi_image_free(job.rgba);
+        if (this->isUploading) {
+            glDeleteTextures(1, &this->uploadTex);
+            stbi_image_free(this->uploading.rgba);
+        }
+        if (this->pbo)
+            glDeleteBuffers(1, &this->pbo);
+    }
+
+    void loadPixels(const std::string &path, PixelsCallback onPixels) {
+        Job job;
+        job.path = path;
+        job.texture = false;
+        job.filter = GL_NEAREST;
+        job.onPixels = onPixels;
+        request(job);
+    }
+
+    void loadTexture(const std::string &path, TextureCallback onTexture, GLint filter = GL_NEAREST) {
+        Job job;
+        job.path = path;
+        job.texture = true;
+        job.filter = filter;
+        job.onTexture = onTexture;
+        request(job);
+    }
+
+    // Entrega o que já foi decodificado até gastar budgetMs (pelo menos um passo
+    // por chamada, para sempre andar). Deixa GL_TEXTURE_2D desligada da unidade
+    // ativa. Devolve quantos pedidos foram entregues.
+    int update(double budgetMs) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int delivered = 0;
+        bool touchedGL = false;
+        for (;;) {
+            if (this->isUploading) {
+                uploadStrip();
+                touchedGL = true;
+                if (!this->isUploading)
+                    delivered++;
+            } else {
+                Job job;
+                {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    if (this->decoded.empty())
+                        break;
+                    job = this->decoded.front();
+                    this->decoded.pop_front();
+                }
+                if (job.texture && job.rgba) {
+                    beginUpload(job);
+                    touchedGL = true;
+                } else {
+                    finish(job, 0);
+                    delivered++;
+                }
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budgetMs)
+                break;
+        }
+        if (touchedGL)
+            glBindTexture(GL_TEXTURE_2D, 0);
+        return delivered;
+    }
+
+    // Pedidos feitos e ainda não entregues (na fila, decodificando ou enviando)
+    int getPending() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->pending;
+    }
+
+    bool isIdle() {
+        return getPending() == 0;
+    }
+};
+
+#endif /* AssetLoader_h */
@@ -0,0 +1,241 @@
+//
+//  BinaryMap.h
+//
+//  Formato binário de mapa (.tbin), pensado para ser lido direto do arquivo
+//  mapeado em memória (mmap / MapViewOfFile), sem cópia e sem parsing:
+//
+//      BinaryMapHeader                  (64 bytes)
+//      nTiles bytes                     propriedade de cada id (TILE_PROP_*)
+//      rows * cols bytes                ids dos tiles, linha a linha
+//
+//  Todos os inteiros são little-endian. Ids cabem em um byte, como em TileMap
+//  e ChunkedTileMap. Arquivos são gerados por src/Ferramentas/ConverteMapa.cpp
+//  a partir dos .txt do Trabfinal, dos .tmap e dos .tmx.
+//
+
+#ifndef BinaryMap_h
+#define BinaryMap_h
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BINARY_MAP_MAGIC "PGTM"
+#define BINARY_MAP_VERSION 1
+
+enum BinaryTileProp {
+    TILE_PROP_UNKNOWN = 0,
+    TILE_PROP_WALKABLE,
+    TILE_PROP_DEADLY,
+    TILE_PROP_BLOCKED,
+    TILE_PROP_COIN
+};
+
+struct BinaryMapHeader {
+    char magic[4];          // "PGTM"
+    uint32_t version;
+    int32_t cols, rows;
+    int32_t tileW, tileH;   // em pixels (0 se a origem não informa)
+    int32_t nTiles;         // quantidade de propriedades gravadas
+    int32_t startRow, startCol;
+    char tileset[28];       // nome do arquivo do tileset, terminado em '\0'
+};
+static_assert(sizeof(BinaryMapHeader) == 64, "cabeçalho do .tbin deve ter 64 bytes");
+
+// Arquivo inteiro mapeado só para leitura; desmapeado no destrutor
+class MappedFile {
+    const unsigned char *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+public:
+    MappedFile() {
+        this->data = NULL;
+        this->size = 0;
+#ifdef _WIN32
+        this->file = INVALID_HANDLE_VALUE;
+        this->mapping = NULL;
+#else
+        this->fd = -1;
+#endif
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (this->file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        this->size = (size_t)fileSize.QuadPart;
+        this->mapping = CreateFileMappingA(this->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (this->mapping)
+            this->data = (const unsigned char *)MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        this->fd = ::open(path.c_str(), O_RDONLY);
+        if (this->fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(this->fd, &st) != 0 || st.st_size == 0) {
+            close();
+            return false;
+        }
+        this->size = (size_t)st.st_size;
+        void *p = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, this->fd, 0);
+        if (p != MAP_FAILED)
+            this->data = (const unsigned char *)p;
+#endif
+        if (!this->data) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (this->data)
+            UnmapViewOfFile(this->data);
+        if (this->mapping)
+            CloseHandle(this->mapping);
+        if (this->file != INVALID_HANDLE_VALUE)
+            CloseHandle(this->file);
+        this->file = INVALID_HANDLE_VALUE;
+        this->mapping = NULL;
+#else
+        if (this->data)
+            munmap((void *)this->data, this->size);
+        if (this->fd >= 0)
+            ::close(this->fd);
+        this->fd = -1;
+#endif
+        this->data = NULL;
+        this->size = 0;
+    }
+
+    const unsigned char *getData() const {
+        return this->data;
+    }
+
+    size_t getSize() const {
+        return this->size;
+    }
+};
+
+// Mapa .tbin aberto: os ponteiros apontam para dentro do arquivo mapeado e
+// valem até close() ou a destruição do objeto.
+class BinaryMap {
+    MappedFile file;
+    const BinaryMapHeader *header;
+    const unsigned char *props;
+    const unsigned char *tiles;
+
+public:
+    BinaryMap() {
+        this->header = NULL;
+        this->props = this->tiles = NULL;
+    }
+
+    // Só valida o cabeçalho e o tamanho; nenhum tile é lido aqui
+    bool open(const std::string &path, std::string &err) {
+        close();
+        if (!this->file.open(path)) {
+            err = "Não foi possível mapear o arquivo: " + path;
+            return false;
+        }
+        const unsigned char *base = this->file.getData();
+        size_t size = this->file.getSize();
+        const BinaryMapHeader *h = (const BinaryMapHeader *)base;
+        if (size < sizeof(BinaryMapHeader) || memcmp(h->magic, BINARY_MAP_MAGIC, 4) != 0) {
+            err = path + " não é um mapa .tbin";
+            close();
+            return false;
+        }
+        if (h->version != BINARY_MAP_VERSION) {
+            err = path + ": versão " + std::to_string(h->version) + " não suportada";
+            close();
+            return false;
+        }
+        if (h->cols <= 0 || h->rows <= 0 || h->nTiles < 0 ||
+            size != sizeof(BinaryMapHeader) + (size_t)h->nTiles + (size_t)h->cols * h->rows) {
+            err = path + ": tamanho não confere com o cabeçalho";
+            close();
+            return false;
+        }
+        this->header = h;
+        this->props = base + sizeof(BinaryMapHeader);
+        this->tiles = this->props + h->nTiles;
+        return true;
+    }
+
+    void close() {
+        this->file.close();
+        this->header = NULL;
+        this->props = this->tiles = NULL;
+    }
+
+    const BinaryMapHeader &getHeader() const {
+        return *this->header;
+    }
+
+    // rows * cols ids, linha a linha
+    const unsigned char *getTiles() const {
+        return this->tiles;
+    }
+
+    const unsigned char *getProps() const {
+        return this->props;
+    }
+
+    int getTile(int col, int row) const {
+        return this->tiles[col + row * this->header->cols];
+    }
+
+    // Grava um .tbin. tiles: rows * cols ids, linha a linha; props: nTiles TILE_PROP_*
+    static bool write(const std::string &path, BinaryMapHeader header, const unsigned char *tiles,
+                      const unsigned char *props, std::string &err) {
+        memcpy(header.magic, BINARY_MAP_MAGIC, 4);
+        header.version = BINARY_MAP_VERSION;
+        FILE *out = fopen(path.c_str(), "wb");
+        if (!out) {
+            err = "Não foi possível criar " + path;
+            return false;
+        }
+        size_t nTiles = (size_t)header.cols * header.rows;
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  fwrite(props, 1, header.nTiles, out) == (size_t)header.nTiles &&
+                  fwrite(tiles, 1, nTiles, out) == nTiles;
+        ok = (fclose(out) == 0) && ok;
+        if (!ok)
+            err = "Falha ao gravar " + path;
+        return ok;
+    }
+};
+
+#endif /* BinaryMap_h */
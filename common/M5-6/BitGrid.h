@@ -0,0 +1,136 @@
+//
+//  BitGrid.h
+//
+//  Um bit por tile (rows x cols), linha a linha, em palavras de 64 bits; cada
+//  linha começa numa palavra nova. Serve de máscara de propriedade do mapa
+//  ("caminhável", "perigoso", "tem moeda"...): um mapa de 4096x4096 cabe em
+//  2 MB por propriedade, e as consultas de retângulo (count, any) contam 64
+//  tiles por instrução de popcount, em vez de olhar tile a tile.
+//
+
+#ifndef BitGrid_h
+#define BitGrid_h
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Com a instrução de popcount disponível (ou no ARM), o builtin do compilador;
+// sem ela (x86 sem -mpopcnt, o padrão do gcc), o builtin vira chamada de
+// função, e a conta em paralelo nos bytes da palavra sai mais rápida
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BITGRID_POPCOUNT(x) ((int)__popcnt64(x))
+#elif defined(__POPCNT__) || defined(__aarch64__)
+#define BITGRID_POPCOUNT(x) __builtin_popcountll(x)
+#else
+#define BITGRID_POPCOUNT(x) bitgridPopcount(x)
+#endif
+
+inline int bitgridPopcount(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+}
+
+class BitGrid {
+    int rows, cols;
+    int words;                  // palavras por linha
+    std::vector<uint64_t> bits;
+
+    // Bits [c0, c1) de uma palavra que começa na coluna base
+    static uint64_t span(int base, int c0, int c1) {
+        uint64_t lo = c0 <= base ? ~0ull : ~0ull << (c0 - base);
+        uint64_t hi = c1 >= base + 64 ? ~0ull : ~(~0ull << (c1 - base));
+        return lo & hi;
+    }
+
+    // Recorta [col0, col1) x [row0, row1) ao mapa; false se ficou vazio
+    bool clip(int &col0, int &row0, int &col1, int &row1) const {
+        col0 = col0 < 0 ? 0 : col0;
+        row0 = row0 < 0 ? 0 : row0;
+        col1 = col1 > this->cols ? this->cols : col1;
+        row1 = row1 > this->rows ? this->rows : row1;
+        return col0 < col1 && row0 < row1;
+    }
+
+public:
+    BitGrid() {
+        this->rows = this->cols = this->words = 0;
+    }
+
+    // Redimensiona e zera todos os bits
+    void resize(int rows, int cols) {
+        this->rows = rows;
+        this->cols = cols;
+        this->words = (cols + 63) / 64;
+        this->bits.assign((size_t)rows * this->words, 0);
+    }
+
+    void clear() {
+        std::fill(this->bits.begin(), this->bits.end(), 0);
+    }
+
+    bool test(int col, int row) const {
+        return (this->bits[(size_t)row * this->words + (col >> 6)] >> (col & 63)) & 1;
+    }
+
+    void set(int col, int row, bool value = true) {
+        uint64_t &w = this->bits[(size_t)row * this->words + (col >> 6)];
+        uint64_t bit = 1ull << (col & 63);
+        w = value ? (w | bit) : (w & ~bit);
+    }
+
+    // Tiles com o bit ligado em [col0, col1) x [row0, row1) (recortado ao mapa)
+    size_t count(int col0, int row0, int col1, int row1) const {
+        if (!clip(col0, row0, col1, row1))
+            return 0;
+        int w0 = col0 >> 6, w1 = (col1 - 1) >> 6;
+        size_t total = 0;
+        for (int row = row0; row < row1; row++) {
+            const uint64_t *line = &this->bits[(size_t)row * this->words];
+            if (w0 == w1) {
+                total += BITGRID_POPCOUNT(line[w0] & span(w0 * 64, col0, col1));
+                continue;
+            }
+            total += BITGRID_POPCOUNT(line[w0] & span(w0 * 64, col0, col1));
+            for (int w = w0 + 1; w < w1; w++)
+                total += BITGRID_POPCOUNT(line[w]);
+            total += BITGRID_POPCOUNT(line[w1] & span(w1 * 64, col0, col1));
+        }
+        return total;
+    }
+
+    // Algum tile com o bit ligado no retângulo? Para na primeira palavra não nula.
+    bool any(int col0, int row0, int col1, int row1) const {
+        if (!clip(col0, row0, col1, row1))
+            return false;
+        int w0 = col0 >> 6, w1 = (col1 - 1) >> 6;
+        for (int row = row0; row < row1; row++) {
+            const uint64_t *line = &this->bits[(size_t)row * this->words];
+            for (int w = w0; w <= w1; w++)
+                if (line[w] & span(w * 64, col0, col1))
+                    return true;
+        }
+        return false;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : this->bits)
+            total += BITGRID_POPCOUNT(w);
+        return total;
+    }
+
+    int getRows() const {
+        return this->rows;
+    }
+
+    int getCols() const {
+        return this->cols;
+    }
+};
+
+#endif /* BitGrid_h */
@@ -0,0 +1,273 @@
+//
+//  ChunkedTileMap.h
+//
+//  Tilemap dividido em chunks de CHUNK_SIZE x CHUNK_SIZE tiles. Cada chunk tem
+//  a sua própria malha na GPU (4 vértices por tile, com posição e UV do
+//  tileset já calculadas) e uma flag de "sujo": setTile só marca o chunk do
+//  tile alterado, e na hora de desenhar apenas os chunks sujos são reenviados.
+//  A malha de um chunk só é criada na primeira vez que ele é desenhado.
+//
+
+#ifndef ChunkedTileMap_h
+#define ChunkedTileMap_h
+
+#include <glad/glad.h>
+#include <vector>
+#include "TilemapView.h"
+
+#define CHUNK_SIZE 32
+#define CHUNK_TILES (CHUNK_SIZE * CHUNK_SIZE)
+
+class ChunkedTileMap {
+    struct Chunk {
+        unsigned char tiles[CHUNK_TILES]; // ids dos tiles, linha a linha dentro do chunk
+        GLuint vao, vbo;                  // 0 enquanto o chunk nunca foi desenhado
+        bool dirty;
+    };
+
+    float z;
+    unsigned int tid;           // tileset (textura) usado
+    int width, height;          // dimensões do mapa em tiles
+    int chunksX, chunksY;       // dimensões do mapa em chunks
+    std::vector<Chunk> chunks;
+    GLuint ebo;                 // índices compartilhados por todos os chunks
+    std::vector<GLfloat> vertices; // malha do chunk sendo enviado; a capacidade fica para o próximo
+
+    // Geometria: visão, tamanho do tile, origem na tela e grade do tileset
+    const TilemapView *view;
+    float tw, th, x0, y0;
+    int tilesetCols, tilesetRows;
+    float u0, v0, u1, v1;       // retângulo do tileset na textura (ex.: dentro de um atlas)
+
+    Chunk &chunkAt(int col, int row) {
+        return this->chunks[(col / CHUNK_SIZE) + (row / CHUNK_SIZE) * this->chunksX];
+    }
+
+    // Vértices (x, y, s, t) de todos os tiles do chunk (cx, cy), em ordem de desenho, em this->vertices
+    void buildChunk(int cx, int cy) {
+        std::vector<GLfloat> &vertices = this->vertices;
+        Chunk &chunk = this->chunks[cx + cy * this->chunksX];
+        float du = (this->u1 - this->u0) / this->tilesetCols;
+        float dv = (this->v1 - this->v0) / this->tilesetRows;
+
+        vertices.clear();
+        for (int r = 0; r < CHUNK_SIZE; r++) {
+            int row = cy * CHUNK_SIZE + r;
+            for (int c = 0; c < CHUNK_SIZE; c++) {
+                int col = cx * CHUNK_SIZE + c;
+                if (col >= this->width || row >= this->height) {
+                    // tiles fora do mapa (chunks da borda) viram losangos degenerados
+                    vertices.insert(vertices.end(), 16, 0.0f);
+                    continue;
+                }
+                int t_id = chunk.tiles[c + r * CHUNK_SIZE];
+                float u = this->u0 + (t_id % this->tilesetCols) * du;
+                float v = this->v0 + (t_id / this->tilesetCols) * dv;
+
+                float x, y;
+                this->view->computeDrawPosition(col, row, this->tw, this->th, x, y);
+                x += this->x0;
+                y += this->y0;
+
+                GLfloat quad[] = {
+                    x,                   y + this->th / 2.0f, u,             v + dv / 2.0f, // esquerda
+                    x + this->tw / 2.0f, y + this->th,        u + du / 2.0f, v + dv,        // meio, em y + th
+                    x + this->tw / 2.0f, y,                   u + du / 2.0f, v,             // meio, em y
+                    x + this->tw,        y + this->th / 2.0f, u + du,        v + dv / 2.0f  // direita
+                };
+                vertices.insert(vertices.end(), quad, quad + 16);
+            }
+        }
+    }
+
+    void upload(int cx, int cy) {
+        Chunk &chunk = this->chunks[cx + cy * this->chunksX];
+        buildChunk(cx, cy);
+        const std::vector<GLfloat> &vertices = this->vertices;
+
+        if (chunk.vao == 0) {
+            glGenVertexArrays(1, &chunk.vao);
+            glBindVertexArray(chunk.vao);
+
+            glGenBuffers(1, &chunk.vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_DYNAMIC_DRAW);
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)(2 * sizeof(GLfloat)));
+            glEnableVertexAttribArray(1);
+
+            glBindVertexArray(0);
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(GLfloat), vertices.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        chunk.dirty = false;
+    }
+
+public:
+    ChunkedTileMap(int w, int h, unsigned char initWith) {
+        this->width = w;
+        this->height = h;
+        this->chunksX = (w + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        this->chunksY = (h + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        this->chunks.resize(this->chunksX * this->chunksY);
+        for (Chunk &chunk : this->chunks) {
+            for (int i = 0; i < CHUNK_TILES; i++)
+                chunk.tiles[i] = initWith;
+            chunk.vao = chunk.vbo = 0;
+            chunk.dirty = true;
+        }
+        this->z = 0.0f;
+        this->tid = 0;
+        this->ebo = 0;
+        this->view = NULL;
+        this->tw = this->th = 1.0f;
+        this->x0 = this->y0 = 0.0f;
+        this->tilesetCols = this->tilesetRows = 1;
+        this->u0 = this->v0 = 0.0f;
+        this->u1 = this->v1 = 1.0f;
+    }
+
+    // O destrutor apaga os VAOs e VBOs: uma cópia apagaria os mesmos nomes duas vezes
+    ChunkedTileMap(const ChunkedTileMap &) = delete;
+    ChunkedTileMap &operator=(const ChunkedTileMap &) = delete;
+
+    ~ChunkedTileMap() {
+        for (Chunk &chunk : this->chunks) {
+            if (chunk.vao) {
+                glDeleteVertexArrays(1, &chunk.vao);
+                glDeleteBuffers(1, &chunk.vbo);
+            }
+        }
+        if (this->ebo)
+            glDeleteBuffers(1, &this->ebo);
+    }
+
+    // Define como os tiles viram geometria. Invalida todas as malhas.
+    void setLayout(const TilemapView *view, float tw, float th, float x0, float y0, int tilesetCols, int tilesetRows) {
+        this->view = view;
+        this->tw = tw;
+        this->th = th;
+        this->x0 = x0;
+        this->y0 = y0;
+        this->tilesetCols = tilesetCols;
+        this->tilesetRows = tilesetRows;
+        for (Chunk &chunk : this->chunks)
+            chunk.dirty = true;
+    }
+
+    // Parte da textura ocupada pelo tileset, nas coordenadas que o shader
+    // recebe (padrão: a textura inteira). Invalida todas as malhas.
+    void setTilesetRect(float u0, float v0, float u1, float v1) {
+        this->u0 = u0;
+        this->v0 = v0;
+        this->u1 = u1;
+        this->v1 = v1;
+        for (Chunk &chunk : this->chunks)
+            chunk.dirty = true;
+    }
+
+    int getWidth() {
+        return this->width;
+    }
+
+    int getHeight() {
+        return this->height;
+    }
+
+    int getChunksX() {
+        return this->chunksX;
+    }
+
+    int getChunksY() {
+        return this->chunksY;
+    }
+
+    int getTile(int col, int row) {
+        return chunkAt(col, row).tiles[(col % CHUNK_SIZE) + (row % CHUNK_SIZE) * CHUNK_SIZE];
+    }
+
+    void setTile(int col, int row, unsigned char tile) {
+        Chunk &chunk = chunkAt(col, row);
+        unsigned char &t = chunk.tiles[(col % CHUNK_SIZE) + (row % CHUNK_SIZE) * CHUNK_SIZE];
+        if (t != tile) {
+            t = tile;
+            chunk.dirty = true;
+        }
+    }
+
+    int getTileSet() {
+        return this->tid;
+    }
+
+    float getZ() {
+        return this->z;
+    }
+
+    void setZ(float z){
+        this->z = z;
+    }
+
+    void setTid(int tid) {
+        this->tid = tid;
+    }
+
+    // Desenha o chunk (cx, cy), reenviando a malha antes se ele estiver sujo.
+    // Espera o shader e a textura do tileset já ativos.
+    void drawChunk(int cx, int cy) {
+        if (this->ebo == 0) {
+            std::vector<GLuint> indices(CHUNK_TILES * 6);
+            for (GLuint t = 0; t < CHUNK_TILES; t++) {
+                GLuint base = t * 4;
+                GLuint quad[] = {base, base + 1, base + 2, base + 2, base + 1, base + 3};
+                for (int k = 0; k < 6; k++)
+                    indices[t * 6 + k] = quad[k];
+            }
+            glGenBuffers(1, &this->ebo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }
+
+        Chunk &chunk = this->chunks[cx + cy * this->chunksX];
+        if (chunk.dirty)
+            upload(cx, cy);
+
+        glBindVertexArray(chunk.vao);
+        glDrawElements(GL_TRIANGLES, CHUNK_TILES * 6, GL_UNSIGNED_INT, 0);
+    }
+
+    void draw() {
+        glBindTexture(GL_TEXTURE_2D, this->tid);
+        for (int cy = 0; cy < this->chunksY; cy++)
+            for (int cx = 0; cx < this->chunksX; cx++)
+                drawChunk(cx, cy);
+        glBindVertexArray(0);
+    }
+
+    // Desenha só os chunks que contêm algum tile dos spans visíveis
+    // (ver TilemapView::computeVisibleSpans), em ordem de linha.
+    void draw(const std::vector<TileSpan> &spans) {
+        glBindTexture(GL_TEXTURE_2D, this->tid);
+        size_t i = 0;
+        while (i < spans.size()) {
+            // junta os spans da mesma faixa de chunks
+            int cy = spans[i].row / CHUNK_SIZE;
+            int colBegin = spans[i].colBegin, colEnd = spans[i].colEnd;
+            for (; i < spans.size() && spans[i].row / CHUNK_SIZE == cy; i++) {
+                if (spans[i].colBegin < colBegin) colBegin = spans[i].colBegin;
+                if (spans[i].colEnd > colEnd) colEnd = spans[i].colEnd;
+            }
+            for (int cx = colBegin / CHUNK_SIZE; cx <= (colEnd - 1) / CHUNK_SIZE; cx++)
+                drawChunk(cx, cy);
+        }
+        glBindVertexArray(0);
+    }
+};
+
+#endif /* ChunkedTileMap_h */
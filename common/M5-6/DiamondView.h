@@ -0,0 +1,63 @@
+//
+//  DiamondView.h
+//
+//  Visão diamond: a coluna cresce para cima-direita e a linha para baixo-direita
+//  (eixo y para cima). Um mapa quadrado de N tiles ocupa N*tw de largura.
+//
+
+#ifndef DiamondView_h
+#define DiamondView_h
+
+#include "TilemapView.h"
+#include <cmath>
+
+class DiamondView : public TilemapView {
+public:
+    void computeDrawPosition(const int col, const int row, const float tw, const float th, float &targetx, float &targety) const {
+        targetx = (col + row) * tw / 2.0f;
+        targety = (col - row) * th / 2.0f;
+    }
+
+    void computeMouseMap(int &col, int &row, const float tw, const float th, const float mx, const float my) const {
+        // eixos do losango: u conta colunas, v conta linhas (centro do tile (c, r) em u = c+1, v = r)
+        float a = mx / (tw / 2.0f);
+        float b = my / (th / 2.0f);
+        col = (int) floor((a + b) / 2.0f - 0.5f);
+        row = (int) floor((a - b) / 2.0f + 0.5f);
+    }
+
+    void computeTileWalking(int &col, int &row, const int direction) const {
+        switch(direction){
+            case DIRECTION_NORTH:
+                col++;
+                row--;
+                break;
+            case DIRECTION_SOUTH:
+                col--;
+                row++;
+                break;
+            case DIRECTION_EAST:
+                col++;
+                row++;
+                break;
+            case DIRECTION_WEST:
+                col--;
+                row--;
+                break;
+            case DIRECTION_NORTHEAST:
+                col++;
+                break;
+            case DIRECTION_NORTHWEST:
+                row--;
+                break;
+            case DIRECTION_SOUTHEAST:
+                row++;
+                break;
+            case DIRECTION_SOUTHWEST:
+                col--;
+                break;
+        }
+    }
+};
+
+#endif /* DiamondView_h */
@@ -0,0 +1,64 @@
+//
+//  IsometricView.h
+//
+//  Visão isométrica no mesmo arranjo do Tiled (orientation="isometric") e do
+//  Trabfinal: a coluna cresce para baixo-direita e a linha para baixo-esquerda.
+//
+
+#ifndef IsometricView_h
+#define IsometricView_h
+
+#include "TilemapView.h"
+#include <cmath>
+
+class IsometricView : public TilemapView {
+public:
+    void computeDrawPosition(const int col, const int row, const float tw, const float th, float &targetx, float &targety) const {
+        targetx = (col - row) * tw / 2.0f;
+        targety = (col + row) * th / 2.0f;
+    }
+
+    void computeMouseMap(int &col, int &row, const float tw, const float th, const float mx, const float my) const {
+        // eixos do losango: u conta colunas, v conta linhas (centro do tile (c, r) em u = c+1, v = r)
+        float a = mx / (tw / 2.0f);
+        float b = my / (th / 2.0f);
+        col = (int) floor((a + b) / 2.0f - 0.5f);
+        row = (int) floor((b - a) / 2.0f + 0.5f);
+    }
+
+    // Mesmas direções das teclas Q/W/E/A/D/Z/X/C do Trabfinal
+    void computeTileWalking(int &col, int &row, const int direction) const {
+        switch(direction){
+            case DIRECTION_NORTH:
+                row--;
+                break;
+            case DIRECTION_SOUTH:
+                row++;
+                break;
+            case DIRECTION_EAST:
+                col++;
+                break;
+            case DIRECTION_WEST:
+                col--;
+                break;
+            case DIRECTION_NORTHEAST:
+                row--;
+                col++;
+                break;
+            case DIRECTION_NORTHWEST:
+                row--;
+                col--;
+                break;
+            case DIRECTION_SOUTHEAST:
+                row++;
+                col++;
+                break;
+            case DIRECTION_SOUTHWEST:
+                row++;
+                col--;
+                break;
+        }
+    }
+};
+
+#endif /* IsometricView_h */
@@ -0,0 +1,225 @@
+//
+//  ParallaxBackground.h
+//
+//  Fundo em camadas com parallax, desenhado num só draw. As imagens das
+//  camadas (todas do mesmo tamanho) vão para uma textura array, uma camada
+//  da textura por camada do fundo, e um triângulo que cobre a viewport
+//  compõe todas no fragment shader: cada camada anda scroll * fator dela em
+//  UV, e o fator fica numa uniform, então a CPU só manda o scroll.
+//
+//  As camadas são percorridas da frente para trás, acumulando a cor com o
+//  alfa que ainda falta cobrir; quando um pixel fica opaco (céu, morros
+//  cheios) as camadas de trás nem são lidas. Com 10 camadas, em vez de 10
+//  draws e 10 escritas por pixel, é um draw e uma escrita.
+//
+//  Uso:
+//    ParallaxBackground fundo;
+//    fundo.load({"1.png", "2.png", ...}, err);   // do fundo para a frente
+//    fundo.setFactor(i, 0.3f);                  // 0: parada, 1: anda com o scroll
+//    fundo.draw(scrollX, scrollY);              // scroll em UV (1 = uma tela)
+//
+//  O resultado é misturado sobre o que já está na viewport (cor pré-
+//  multiplicada); o estado de blend de quem chama é restaurado no fim.
+//  Precisa de stb_image.h (STB_IMAGE_IMPLEMENTATION em algum .cpp).
+//
+
+#ifndef ParallaxBackground_h
+#define ParallaxBackground_h
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define PARALLAX_MAX_LAYERS 16 // tamanho do array de fatores no shader
+
+class ParallaxBackground {
+    GLuint texture, vao, shader;
+    GLint factorsLoc, scrollLoc, viewportLoc, countLoc, layersLoc;
+    int layers;
+    float factors[PARALLAX_MAX_LAYERS];
+
+    static GLuint compile(GLenum type, const char *src) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::PARALLAX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    void setupShader() {
+        // Triângulo que cobre a tela, sem buffer de vértices
+        const char *vertex_shader_src =
+            "#version 410 core\n"
+            "void main() {\n"
+            "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+            "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+            "}\n";
+
+        // Frente (última camada) para trás. As derivadas de uv são as mesmas
+        // em todas as camadas (só o deslocamento muda) e são calculadas fora
+        // do laço: com a saída antecipada, o texture() dentro dele não teria
+        // derivadas certas para escolher o mipmap.
+        const char *fragment_shader_src =
+            "#version 410 core\n"
+            "uniform sampler2DArray layers;\n"
+            "uniform int layerCount;\n"
+            "uniform float factors[16];\n" // PARALLAX_MAX_LAYERS
+            "uniform vec2 scroll;\n"
+            "uniform vec4 viewport;\n"
+            "out vec4 FragColor;\n"
+            "void main() {\n"
+            "    vec2 uv = (gl_FragCoord.xy - viewport.xy) / viewport.zw;\n"
+            "    uv.y = 1.0 - uv.y;\n"
+            "    vec2 dx = dFdx(uv), dy = dFdy(uv);\n"
+            "    vec4 sum = vec4(0.0);\n"
+            "    for (int i = layerCount - 1; i >= 0 && sum.a < 0.996; i--) {\n"
+            "        vec4 c = textureGrad(layers, vec3(uv + scroll * factors[i], float(i)), dx, dy);\n"
+            "        sum += (1.0 - sum.a) * vec4(c.rgb * c.a, c.a);\n"
+            "    }\n"
+            "    FragColor = sum;\n"
+            "}\n";
+
+        GLuint vs = compile(GL_VERTEX_SHADER, vertex_shader_src);
+        GLuint fs = compile(GL_FRAGMENT_SHADER, fragment_shader_src);
+        this->shader = glCreateProgram();
+        glAttachShader(this->shader, vs);
+        glAttachShader(this->shader, fs);
+        glLinkProgram(this->shader);
+        GLint success;
+        glGetProgramiv(this->shader, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(this->shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::PARALLAX::LINKING_FAILED\n" << infoLog << std::endl;
+        }
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        this->factorsLoc = glGetUniformLocation(this->shader, "factors");
+        this->scrollLoc = glGetUniformLocation(this->shader, "scroll");
+        this->viewportLoc = glGetUniformLocation(this->shader, "viewport");
+        this->countLoc = glGetUniformLocation(this->shader, "layerCount");
+        this->layersLoc = glGetUniformLocation(this->shader, "layers");
+    }
+
+public:
+    ParallaxBackground() {
+        this->texture = this->vao = this->shader = 0;
+        this->layers = 0;
+        for (int i = 0; i < PARALLAX_MAX_LAYERS; i++)
+            this->factors[i] = 0.0f;
+    }
+
+    // Precisa do contexto ainda ativo
+    ~ParallaxBackground() {
+        if (this->texture)
+            glDeleteTextures(1, &this->texture);
+        if (this->vao) {
+            glDeleteVertexArrays(1, &this->vao);
+            glDeleteProgram(this->shader);
+        }
+    }
+
+    // Carrega as camadas, da mais ao fundo para a mais à frente; precisa de
+    // um contexto GL ativo. false (e err) se alguma imagem falta, tem tamanho
+    // diferente da primeira, ou se são mais de PARALLAX_MAX_LAYERS.
+    bool load(const std::vector<std::string> &files, std::string &err) {
+        if (files.empty() || files.size() > PARALLAX_MAX_LAYERS) {
+            err = "o fundo precisa de 1 a " + std::to_string(PARALLAX_MAX_LAYERS) + " camadas";
+            return false;
+        }
+        if (!this->vao) {
+            setupShader();
+            glGenVertexArrays(1, &this->vao);
+        }
+        if (this->texture)
+            glDeleteTextures(1, &this->texture);
+        this->texture = 0;
+        this->layers = 0;
+
+        int w = 0, h = 0;
+        for (size_t i = 0; i < files.size(); i++) {
+            int x, y, n;
+            unsigned char *data = stbi_load(files[i].c_str(), &x, &y, &n, 4);
+            if (!data) {
+                err = "não foi possível carregar " + files[i];
+                return false;
+            }
+            if (i == 0) {
+                w = x;
+                h = y;
+                glGenTextures(1, &this->texture);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, this->texture);
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, w, h, (GLsizei)files.size(), 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, NULL);
+            } else if (x != w || y != h) {
+                stbi_image_free(data);
+                err = files[i] + " tem " + std::to_string(x) + "x" + std::to_string(y) + ", e as camadas precisam ter " +
+                      std::to_string(w) + "x" + std::to_string(h) + " como a primeira";
+                return false;
+            }
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)i, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            stbi_image_free(data);
+        }
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        this->layers = (int)files.size();
+        return true;
+    }
+
+    int getLayers() const {
+        return this->layers;
+    }
+
+    // Quanto a camada anda com o scroll
+    void setFactor(int layer, float factor) {
+        this->factors[layer] = factor;
+    }
+
+    // Desenha todas as camadas na viewport atual, deslocadas de scroll * fator
+    void draw(float scrollX, float scrollY) {
+        if (!this->layers)
+            return;
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        GLboolean blend = glIsEnabled(GL_BLEND);
+        GLint srcRGB, dstRGB, srcAlpha, dstAlpha;
+        glGetIntegerv(GL_BLEND_SRC_RGB, &srcRGB);
+        glGetIntegerv(GL_BLEND_DST_RGB, &dstRGB);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, &srcAlpha);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, &dstAlpha);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(this->shader);
+        glUniform1fv(this->factorsLoc, this->layers, this->factors);
+        glUniform2f(this->scrollLoc, scrollX, scrollY);
+        glUniform4f(this->viewportLoc, (float)viewport[0], (float)viewport[1], (float)viewport[2], (float)viewport[3]);
+        glUniform1i(this->countLoc, this->layers);
+        glUniform1i(this->layersLoc, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->texture);
+        glBindVertexArray(this->vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+        if (!blend)
+            glDisable(GL_BLEND);
+    }
+};
+
+#endif /* ParallaxBackground_h */
@@ -0,0 +1,371 @@
+//
+//  Pathfinding.h
+//
+//  Caminhos sobre uma grade de tiles caminháveis, com os 8 movimentos que a
+//  visão dá em computeTileWalking (no Trabfinal, IsometricView: as teclas
+//  Q/W/E/A/D/Z/X/C). Todo passo custa 1, como no jogo, e a diagonal não
+//  precisa dos vizinhos livres (Jogo::passo só olha o tile de destino).
+//
+//   - PathGrid: a grade (rows x cols, 0 = não passa) e os deslocamentos das
+//     8 direções.
+//   - AStar: um agente, um caminho. As listas (aberta, custos, de onde veio)
+//     ficam alocadas entre buscas e os últimos caminhos são guardados até
+//     invalidate().
+//   - FlowField: muitos agentes indo para o mesmo destino. Uma busca em
+//     largura a partir do destino dá a distância de cada tile e, para cada
+//     um, a direção do próximo passo; as camadas grandes da busca são
+//     divididas entre threads.
+//
+//  Índice de tile = row * cols + col, como em MapConfig::matrix.
+//
+
+#ifndef Pathfinding_h
+#define Pathfinding_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TilemapView.h"
+
+#define PATH_UNREACHABLE 0xFFFFFFFFu
+#define FLOW_PARALLEL_MIN 4096 // camadas menores que isso são expandidas por uma thread só
+
+// (std::min) e (std::max) entre parênteses: o windows.h define min e max como macros
+
+struct PathGrid {
+    int rows, cols;
+    const unsigned char *walkable;  // rows*cols, não copiado
+    int dcol[8], drow[8];           // direção DIRECTION_* em [direção - 1]
+    bool kingMoves;                 // as 8 vizinhas do tile (vale a distância de Chebyshev)
+
+    PathGrid(int rows, int cols, const unsigned char *walkable, const TilemapView &view) {
+        this->rows = rows;
+        this->cols = cols;
+        this->walkable = walkable;
+        int seen = 0;
+        for (int d = 0; d < 8; d++) {
+            int col = 0, row = 0;
+            view.computeTileWalking(col, row, d + 1);
+            this->dcol[d] = col;
+            this->drow[d] = row;
+            if (abs(col) <= 1 && abs(row) <= 1 && (col || row))
+                seen |= 1 << ((row + 1) * 3 + (col + 1));
+        }
+        this->kingMoves = seen == 0x1EF; // todas menos o centro
+    }
+
+    bool passable(int col, int row) const {
+        return col >= 0 && row >= 0 && col < this->cols && row < this->rows && this->walkable[row * this->cols + col];
+    }
+
+    // Limite inferior de passos entre dois tiles (0 se a visão não for de 8 vizinhas)
+    uint32_t estimate(int col0, int row0, int col1, int row1) const {
+        if (!this->kingMoves)
+            return 0;
+        return (uint32_t)(std::max)(abs(col1 - col0), abs(row1 - row0));
+    }
+};
+
+class AStar {
+    struct OpenNode {
+        uint32_t f, g;
+        int tile;
+    };
+
+    const PathGrid *grid;
+    std::vector<uint32_t> g;
+    std::vector<uint32_t> stamp;    // busca em que g e from valem para o tile
+    std::vector<unsigned char> from; // direção usada para chegar (1..8)
+    std::vector<OpenNode> open;     // heap
+    uint32_t search;
+    std::unordered_map<uint64_t, std::vector<int>> cache;
+    size_t cacheLimit;
+    size_t expanded;
+
+    // Menor f no topo; no empate, o de maior g (mais perto do destino)
+    static bool after(const OpenNode &a, const OpenNode &b) {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+
+public:
+    AStar(const PathGrid &grid, size_t cacheLimit = 1024) {
+        this->grid = &grid;
+        size_t n = (size_t)grid.rows * grid.cols;
+        this->g.resize(n);
+        this->stamp.assign(n, 0);
+        this->from.resize(n);
+        this->search = 0;
+        this->cacheLimit = cacheLimit;
+        this->expanded = 0;
+    }
+
+    // Caminho de (startCol, startRow) até (goalCol, goalRow): os tiles de cada
+    // passo, sem o inicial e com o destino. false se não houver caminho.
+    bool findPath(int startCol, int startRow, int goalCol, int goalRow, std::vector<int> &path) {
+        const PathGrid &grid = *this->grid;
+        path.clear();
+        if (!grid.passable(goalCol, goalRow) || startCol < 0 || startRow < 0 || startCol >= grid.cols ||
+            startRow >= grid.rows)
+            return false;
+        int start = startRow * grid.cols + startCol;
+        int goal = goalRow * grid.cols + goalCol;
+        if (start == goal)
+            return true;
+
+        uint64_t key = (uint64_t)start << 32 | (uint32_t)goal;
+        auto cached = this->cache.find(key);
+        if (cached != this->cache.end()) {
+            path = cached->second;
+            return !path.empty();
+        }
+
+        if (++this->search == 0) { // deu a volta: zera as marcas
+            std::fill(this->stamp.begin(), this->stamp.end(), 0);
+            this->search = 1;
+        }
+        uint32_t s = this->search;
+        this->open.clear();
+        this->stamp[start] = s;
+        this->g[start] = 0;
+        this->from[start] = 0;
+        this->open.push_back({grid.estimate(startCol, startRow, goalCol, goalRow), 0, start});
+
+        bool found = false;
+        while (!this->open.empty()) {
+            std::pop_heap(this->open.begin(), this->open.end(), after);
+            OpenNode node = this->open.back();
+            this->open.pop_back();
+            if (node.g > this->g[node.tile])
+                continue; // já saiu da lista com custo menor
+            if (node.tile == goal) {
+                found = true;
+                break;
+            }
+            this->expanded++;
+            int col = node.tile % grid.cols, row = node.tile / grid.cols;
+            for (int d = 0; d < 8; d++) {
+                int nc = col + grid.dcol[d], nr = row + grid.drow[d];
+                if (!grid.passable(nc, nr))
+                    continue;
+                int next = nr * grid.cols + nc;
+                uint32_t ng = node.g + 1;
+                if (this->stamp[next] == s && this->g[next] <= ng)
+                    continue;
+                this->stamp[next] = s;
+                this->g[next] = ng;
+                this->from[next] = (unsigned char)(d + 1);
+                this->open.push_back({ng + grid.estimate(nc, nr, goalCol, goalRow), ng, next});
+                std::push_heap(this->open.begin(), this->open.end(), after);
+            }
+        }
+
+        if (found) {
+            for (int t = goal; t != start;) {
+                path.push_back(t);
+                int d = this->from[t] - 1;
+                t = (t / grid.cols - grid.drow[d]) * grid.cols + (t % grid.cols - grid.dcol[d]);
+            }
+            std::reverse(path.begin(), path.end());
+        }
+        if (this->cache.size() >= this->cacheLimit)
+            this->cache.clear();
+        if (this->cacheLimit > 0)
+            this->cache[key] = path;
+        return found;
+    }
+
+    // A grade mudou: esquece os caminhos guardados
+    void invalidate() {
+        this->cache.clear();
+    }
+
+    // Tiles expandidos desde a criação (para medir)
+    size_t getExpanded() const {
+        return this->expanded;
+    }
+};
+
+class FlowField {
+    const PathGrid *grid;
+    std::unique_ptr<std::atomic<uint32_t>[]> dist;
+    std::vector<unsigned char> dir; // direção (1..8) do próximo passo; 0 no destino ou sem caminho
+    int nThreads;
+
+    // Barreira das threads da busca: espera ocupada com yield, porque cada
+    // camada leva pouco tempo e acordar threads dormindo custaria mais
+    struct Barrier {
+        std::atomic<int> waiting;
+        std::atomic<int> generation;
+        int count;
+
+        void wait() {
+            int gen = this->generation.load();
+            if (this->waiting.fetch_add(1) + 1 == this->count) {
+                this->waiting.store(0);
+                this->generation.fetch_add(1);
+            } else {
+                while (this->generation.load() == gen)
+                    std::this_thread::yield();
+            }
+        }
+    };
+
+    // Camada level + 1: tiles ainda sem distância dos quais um passo leva a
+    // algum tile da fatia [begin, end) da camada atual. Com shared, outras
+    // threads expandem outras fatias ao mesmo tempo e cada tile é disputado
+    // com compare_exchange; sozinha, basta ler e gravar.
+    void expand(const std::vector<int> &frontier, size_t begin, size_t end, uint32_t level, bool shared,
+                std::vector<int> &next) {
+        const PathGrid &grid = *this->grid;
+        for (size_t k = begin; k < end; k++) {
+            int col = frontier[k] % grid.cols, row = frontier[k] / grid.cols;
+            for (int d = 0; d < 8; d++) {
+                int pc = col - grid.dcol[d], pr = row - grid.drow[d];
+                if (!grid.passable(pc, pr))
+                    continue;
+                int prev = pr * grid.cols + pc;
+                if (this->dist[prev].load(std::memory_order_relaxed) != PATH_UNREACHABLE)
+                    continue;
+                if (shared) {
+                    uint32_t expected = PATH_UNREACHABLE;
+                    if (!this->dist[prev].compare_exchange_strong(expected, level + 1, std::memory_order_relaxed))
+                        continue;
+                } else {
+                    this->dist[prev].store(level + 1, std::memory_order_relaxed);
+                }
+                next.push_back(prev);
+            }
+        }
+    }
+
+    // Direção de cada tile das linhas [rowBegin, rowEnd): a primeira, na ordem
+    // DIRECTION_*, que leva a um tile uma camada mais perto (não depende de
+    // qual thread achou o tile primeiro)
+    void directions(int rowBegin, int rowEnd) {
+        const PathGrid &grid = *this->grid;
+        for (int row = rowBegin; row < rowEnd; row++) {
+            for (int col = 0; col < grid.cols; col++) {
+                int tile = row * grid.cols + col;
+                uint32_t d0 = this->dist[tile].load(std::memory_order_relaxed);
+                unsigned char best = 0;
+                if (d0 != 0 && d0 != PATH_UNREACHABLE) {
+                    for (int d = 0; d < 8 && !best; d++) {
+                        int nc = col + grid.dcol[d], nr = row + grid.drow[d];
+                        if (grid.passable(nc, nr) &&
+                            this->dist[nr * grid.cols + nc].load(std::memory_order_relaxed) == d0 - 1)
+                            best = (unsigned char)(d + 1);
+                    }
+                }
+                this->dir[tile] = best;
+            }
+        }
+    }
+
+public:
+    // nThreads <= 0: número de núcleos
+    FlowField(const PathGrid &grid, int nThreads = 0) {
+        this->grid = &grid;
+        size_t n = (size_t)grid.rows * grid.cols;
+        this->dist.reset(new std::atomic<uint32_t>[n]);
+        this->dir.resize(n);
+        if (nThreads <= 0)
+            nThreads = (std::max)(1, (int)std::thread::hardware_concurrency());
+        this->nThreads = nThreads;
+    }
+
+    // Calcula distâncias e direções de todos os tiles até (goalCol, goalRow).
+    // false se o destino não for caminhável.
+    bool build(int goalCol, int goalRow) {
+        const PathGrid &grid = *this->grid;
+        size_t n = (size_t)grid.rows * grid.cols;
+        for (size_t i = 0; i < n; i++)
+            this->dist[i].store(PATH_UNREACHABLE, std::memory_order_relaxed);
+        if (!grid.passable(goalCol, goalRow)) {
+            std::fill(this->dir.begin(), this->dir.end(), 0);
+            return false;
+        }
+
+        int T = this->nThreads;
+        std::vector<int> frontier(1, goalRow * grid.cols + goalCol);
+        std::vector<std::vector<int>> next(T);
+        this->dist[frontier[0]].store(0, std::memory_order_relaxed);
+        uint32_t level = 0;
+        bool done = false;
+
+        // A thread 0 (esta) conduz as camadas; as outras só entram nas grandes,
+        // cada uma com uma fatia da camada
+        Barrier barrier;
+        barrier.waiting.store(0);
+        barrier.generation.store(0);
+        barrier.count = T;
+        auto slice = [&](int t) {
+            size_t size = frontier.size();
+            expand(frontier, size * t / T, size * (t + 1) / T, level, true, next[t]);
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < T; t++) {
+            workers.push_back(std::thread([&, t] {
+                for (;;) {
+                    barrier.wait();
+                    if (done)
+                        break;
+                    slice(t);
+                    barrier.wait();
+                }
+                // Direções: uma faixa de linhas por thread
+                directions(grid.rows * t / T, grid.rows * (t + 1) / T);
+            }));
+        }
+
+        while (!frontier.empty()) {
+            if (T > 1 && frontier.size() >= FLOW_PARALLEL_MIN) {
+                barrier.wait();
+                slice(0);
+                barrier.wait();
+            } else {
+                expand(frontier, 0, frontier.size(), level, false, next[0]);
+            }
+            frontier.clear();
+            for (int t = 0; t < T; t++) {
+                frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+                next[t].clear();
+            }
+            level++;
+        }
+
+        done = true;
+        if (T > 1)
+            barrier.wait();
+        directions(0, grid.rows / T);
+        for (std::thread &t : workers)
+            t.join();
+        return true;
+    }
+
+    // Passos até o destino (PATH_UNREACHABLE se não há caminho)
+    uint32_t getDistance(int col, int row) const {
+        return this->dist[row * this->grid->cols + col].load(std::memory_order_relaxed);
+    }
+
+    // DIRECTION_* do próximo passo, ou 0 no destino / sem caminho
+    int getDirection(int col, int row) const {
+        return this->dir[row * this->grid->cols + col];
+    }
+
+    // Anda um passo na direção do campo; false se já está no destino ou não há caminho
+    bool step(int &col, int &row) const {
+        int d = getDirection(col, row);
+        if (!d)
+            return false;
+        col += this->grid->dcol[d - 1];
+        row += this->grid->drow[d - 1];
+        return true;
+    }
+};
+
+#endif /* Pathfinding_h */
@@ -0,0 +1,178 @@
+//
+//  PickingBuffer.h
+//
+//  Seleção pela GPU: o mapa é desenhado uma segunda vez num framebuffer de
+//  inteiros (GL_RGBA32UI), com cada fragmento gravando (col, row, camada, 1)
+//  do tile em vez da cor. O pixel sob o mouse é copiado para um pixel buffer
+//  object (PBO) e só é lido quando a GPU terminou, um quadro depois, então a
+//  CPU nunca espera pela GPU. Vale o que foi de fato desenhado por cima:
+//  camadas, sprites que se sobrepõem e partes transparentes (descartadas no
+//  shader) ficam certas sem nenhuma conta na CPU.
+//
+//  A cada quadro:
+//    picking.resize(largura, altura);  // não faz nada se não mudou
+//    picking.begin();   // desenhar os tiles com o shader de seleção
+//    picking.end(mouseX, mouseY);      // pede o pixel (coordenadas da janela)
+//    picking.poll(resultado);          // true quando chega um pedido anterior
+//
+//  O shader de seleção escreve em "out uvec4": (col, row, camada, 1); o fundo
+//  fica (0, 0, 0, 0).
+//
+
+#ifndef PickingBuffer_h
+#define PickingBuffer_h
+
+#include <glad/glad.h>
+
+#define PICKING_READS 3 // leituras em andamento ao mesmo tempo (PBOs)
+
+struct PickResult {
+    bool hit;               // false: nada desenhado sob o ponto
+    int col, row, layer;
+};
+
+class PickingBuffer {
+    GLuint fbo, color, depth;
+    int width, height;
+
+    // Leituras: cada uma com o seu PBO e a cerca (fence) que diz quando a GPU terminou
+    GLuint pbos[PICKING_READS];
+    GLsync fences[PICKING_READS];
+    int next;                   // próximo PBO a usar
+    int oldest;                 // leitura pendente mais antiga
+    int pending;
+
+    GLint previousFbo;
+    GLint previousViewport[4];
+
+    void destroyTargets() {
+        if (this->fbo)
+            glDeleteFramebuffers(1, &this->fbo);
+        if (this->color)
+            glDeleteRenderbuffers(1, &this->color);
+        if (this->depth)
+            glDeleteRenderbuffers(1, &this->depth);
+        this->fbo = this->color = this->depth = 0;
+    }
+
+public:
+    PickingBuffer() {
+        this->fbo = this->color = this->depth = 0;
+        this->width = this->height = 0;
+        for (int i = 0; i < PICKING_READS; i++) {
+            this->pbos[i] = 0;
+            this->fences[i] = 0;
+        }
+        this->next = this->oldest = this->pending = 0;
+        this->previousFbo = 0;
+    }
+
+    // Precisa do contexto ainda ativo
+    ~PickingBuffer() {
+        destroyTargets();
+        for (int i = 0; i < PICKING_READS; i++) {
+            if (this->fences[i])
+                glDeleteSync(this->fences[i]);
+        }
+        if (this->pbos[0])
+            glDeleteBuffers(PICKING_READS, this->pbos);
+    }
+
+    // Cria (ou recria, se o tamanho mudou) o framebuffer. false se incompleto.
+    bool resize(int w, int h) {
+        if (this->fbo && w == this->width && h == this->height)
+            return true;
+        destroyTargets();
+        this->width = w;
+        this->height = h;
+
+        glGenRenderbuffers(1, &this->color);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA32UI, w, h);
+        glGenRenderbuffers(1, &this->depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        GLint bound;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
+        glGenFramebuffers(1, &this->fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->depth);
+        bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, bound);
+
+        if (!this->pbos[0]) {
+            glGenBuffers(PICKING_READS, this->pbos);
+            for (int i = 0; i < PICKING_READS; i++) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbos[i]);
+                glBufferData(GL_PIXEL_PACK_BUFFER, 4 * sizeof(GLuint), NULL, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        return ok;
+    }
+
+    // Passa a desenhar no framebuffer de seleção (já limpo), com a viewport dele
+    void begin() {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &this->previousFbo);
+        glGetIntegerv(GL_VIEWPORT, this->previousViewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+        glViewport(0, 0, this->width, this->height);
+        static const GLuint zero[4] = {0, 0, 0, 0};
+        glClearBufferuiv(GL_COLOR, 0, zero);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Volta ao framebuffer anterior e pede o pixel (x, y), em coordenadas da
+    // janela (y para baixo, como o glfwGetCursorPos). Se as leituras anteriores
+    // ainda não voltaram todas, este quadro não pede nada.
+    void end(double x, double y) {
+        int px = (int)x, py = this->height - 1 - (int)y;
+        if (this->pending < PICKING_READS && px >= 0 && py >= 0 && px < this->width && py < this->height) {
+            int i = this->next;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbos[i]);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            glReadPixels(px, py, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, (void *)0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            this->fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            this->next = (i + 1) % PICKING_READS;
+            this->pending++;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, this->previousFbo);
+        glViewport(this->previousViewport[0], this->previousViewport[1], this->previousViewport[2],
+                   this->previousViewport[3]);
+    }
+
+    // Resultado mais recente que já voltou da GPU, sem esperar por ela.
+    // false se nenhuma leitura terminou desde a última chamada.
+    bool poll(PickResult &result) {
+        bool got = false;
+        while (this->pending > 0) {
+            int i = this->oldest;
+            GLenum status = glClientWaitSync(this->fences[i], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            glDeleteSync(this->fences[i]);
+            this->fences[i] = 0;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbos[i]);
+            const GLuint *v = (const GLuint *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4 * sizeof(GLuint), GL_MAP_READ_BIT);
+            if (v) {
+                result.hit = v[3] != 0;
+                result.col = (int)v[0];
+                result.row = (int)v[1];
+                result.layer = (int)v[2];
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                got = true;
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            this->oldest = (i + 1) % PICKING_READS;
+            this->pending--;
+        }
+        return got;
+    }
+};
+
+#endif /* PickingBuffer_h */
@@ -0,0 +1,292 @@
+//
+//  RotationTracks.h
+//
+//  Animação de rotações por quadros-chave, para muitos objetos de uma vez
+//  (hélices, moedas girando, ossos de um esqueleto). Cada trilha é uma
+//  sequência de quadros-chave (tempo, quaternion); os quadros-chave de todas
+//  as trilhas ficam juntos em arrays contíguos, e sample() calcula todas as
+//  trilhas num quadro numa só chamada, em duas passadas:
+//    1. para cada trilha, acha o segmento do tempo pedido, começando pelo
+//       segmento da amostra anterior (cursor): com o tempo andando para a
+//       frente, isso é O(1), sem busca;
+//    2. interpola todos os pares de quadros-chave juntos, 4 por instrução com
+//       SSE, por nlerp (rápido) ou slerp (velocidade angular constante).
+//  O resultado fica em arrays separados de w, x, y e z (getW()...).
+//
+//  Os quaternions estão na ordem (w, x, y, z), a mesma do versor do
+//  maths_funcs.h. Na entrada, cada quadro-chave é normalizado e, se preciso,
+//  trocado de sinal para ficar no mesmo hemisfério do anterior (q e -q são a
+//  mesma rotação): a interpolação sempre vai pelo caminho curto, sem teste.
+//
+
+#ifndef RotationTracks_h
+#define RotationTracks_h
+
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ROTATION_SSE
+#endif
+
+enum RotationInterp {
+    ROTATION_NLERP,         // lerp normalizado: quase igual ao slerp para quadros-chave próximos
+    ROTATION_SLERP
+};
+
+class RotationTracks {
+    // Quadros-chave de todas as trilhas, em sequência
+    std::vector<float> keyTime;
+    std::vector<float> keyQ[4];         // w, x, y, z
+    // Do segmento que começa em cada quadro-chave: ângulo entre os dois
+    // quaternions e 1/sen dele (0 se são praticamente iguais)
+    std::vector<float> segTheta, segInvSin;
+
+    // Por trilha
+    std::vector<int> first, count;
+    std::vector<unsigned char> loop;
+    std::vector<int> cursor;            // segmento da última amostra (relativo a first)
+    std::vector<float> cycle;           // com loop: tempo em que começou a volta atual
+
+    // Pares a interpolar (passada 1 -> passada 2) e resultado, um por trilha
+    std::vector<float> a[4], b[4], u, theta, invSin;
+    std::vector<float> out[4];
+
+    // sen(x) para x em [0, pi/2] (série de Taylor até x^11: erro < 1e-7)
+    static float sinHalfPi(float x) {
+        float x2 = x * x;
+        return x * (1.0f + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (-1.0f / 5040 +
+                   x2 * (1.0f / 362880 + x2 * (-1.0f / 39916800))))));
+    }
+
+#ifdef ROTATION_SSE
+    static __m128 sinHalfPi(__m128 x) {
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 p = _mm_set1_ps(-1.0f / 39916800);
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 362880));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 5040));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 120));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 6));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(p, x);
+    }
+#endif
+
+    // Segmento (relativo a first) e parâmetro u em [0, 1] da trilha k no tempo t
+    void locate(int k, float t, int &seg, float &param) {
+        const float *times = &this->keyTime[this->first[k]];
+        int n = this->count[k];
+        if (n == 1) {
+            seg = 0;
+            param = 0.0f;
+            return;
+        }
+        float t0 = times[0], t1 = times[n - 1];
+        if (this->loop[k] && t1 > t0) {
+            // na mesma volta da amostra anterior, sem fmod
+            float local = t - this->cycle[k];
+            if (local < t0 || local >= t1) {
+                local = std::fmod(t - t0, t1 - t0);
+                local = (local < 0.0f ? local + (t1 - t0) : local) + t0;
+                this->cycle[k] = t - local;
+            }
+            t = local;
+        }
+        if (t <= t0) {
+            seg = 0;
+            param = 0.0f;
+            return;
+        }
+        if (t >= t1) {
+            seg = n - 2;
+            param = 1.0f;
+            return;
+        }
+        int s = this->cursor[k];
+        if (t < times[s]) {
+            // voltou no tempo (ou deu a volta no loop): busca binária
+            int lo = 0, hi = s;
+            while (hi - lo > 1) {
+                int mid = (lo + hi) / 2;
+                if (times[mid] <= t)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            s = lo;
+        } else {
+            // para a frente: em geral ainda o mesmo segmento, ou o seguinte
+            while (times[s + 1] <= t)
+                s++;
+        }
+        this->cursor[k] = s;
+        seg = s;
+        param = (t - times[s]) / (times[s + 1] - times[s]);
+    }
+
+    // Passada 2, do índice i em diante, sem SSE
+    void interpolate(int i, int n, RotationInterp interp) {
+        for (; i < n; i++) {
+            float t = this->u[i], wa = 1.0f - t, wb = t;
+            if (interp == ROTATION_SLERP && this->invSin[i] != 0.0f) {
+                wa = sinHalfPi(this->theta[i] * (1.0f - t)) * this->invSin[i];
+                wb = sinHalfPi(this->theta[i] * t) * this->invSin[i];
+            }
+            float r[4], len2 = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                r[c] = wa * this->a[c][i] + wb * this->b[c][i];
+                len2 += r[c] * r[c];
+            }
+            float scale = interp == ROTATION_NLERP ? 1.0f / std::sqrt(len2) : 1.0f;
+            for (int c = 0; c < 4; c++)
+                this->out[c][i] = r[c] * scale;
+        }
+    }
+
+public:
+    // Nova trilha com n >= 1 quadros-chave: times em ordem estritamente crescente (segundos),
+    // quats com 4 floats (w, x, y, z) por quadro-chave. Com loop, o tempo dá
+    // a volta do último quadro-chave para o primeiro; sem loop, para no
+    // último. Devolve o índice da trilha (a posição dela nos resultados), ou
+    // -1, sem criar a trilha, se n < 1, se os tempos não forem estritamente
+    // crescentes ou se algum quaternion for nulo (o segmento ou a
+    // normalização dividiriam por zero em sample()).
+    int addTrack(const float *times, const float *quats, int n, bool loop = true) {
+        if (n < 1)
+            return -1;
+        for (int i = 0; i < n; i++) {
+            float len2 = 0.0f;
+            for (int c = 0; c < 4; c++)
+                len2 += quats[4 * i + c] * quats[4 * i + c];
+            // !(a > b) também recusa NaN
+            if (!(len2 > 0.0f) || (i > 0 && !(times[i] > times[i - 1])))
+                return -1;
+        }
+        int k = (int)this->first.size();
+        int base = (int)this->keyTime.size();
+        this->first.push_back(base);
+        this->count.push_back(n);
+        this->loop.push_back(loop ? 1 : 0);
+        this->cursor.push_back(0);
+        this->cycle.push_back(0.0f);
+        for (int i = 0; i < n; i++) {
+            float q[4], len2 = 0.0f, d = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                q[c] = quats[4 * i + c];
+                len2 += q[c] * q[c];
+            }
+            float inv = 1.0f / std::sqrt(len2);
+            for (int c = 0; c < 4; c++) {
+                q[c] *= inv;
+                if (i > 0)
+                    d += q[c] * this->keyQ[c].back();
+            }
+            for (int c = 0; c < 4; c++)
+                this->keyQ[c].push_back(d < 0.0f ? -q[c] : q[c]);
+            this->keyTime.push_back(times[i]);
+            this->segTheta.push_back(0.0f);
+            this->segInvSin.push_back(0.0f);
+            if (i > 0) {
+                float dot = std::fabs(d);
+                float th = std::acos(dot < 1.0f ? dot : 1.0f), s = std::sin(th);
+                this->segTheta[base + i - 1] = th;
+                this->segInvSin[base + i - 1] = s < 1e-3f ? 0.0f : 1.0f / s;
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            this->a[c].resize(k + 1);
+            this->b[c].resize(k + 1);
+            this->out[c].resize(k + 1);
+        }
+        this->u.resize(k + 1);
+        this->theta.resize(k + 1);
+        this->invSin.resize(k + 1);
+        return k;
+    }
+
+    int getTracks() const {
+        return (int)this->first.size();
+    }
+
+    // Todas as trilhas: a trilha k no tempo times[k]
+    void sample(const float *times, RotationInterp interp = ROTATION_NLERP) {
+        int n = this->getTracks();
+        // Passada 1: segmento de cada trilha e cópia dos dois quadros-chave
+        for (int k = 0; k < n; k++) {
+            int seg;
+            float param;
+            this->locate(k, times[k], seg, param);
+            int ia = this->first[k] + seg;
+            int ib = this->count[k] > 1 ? ia + 1 : ia;
+            for (int c = 0; c < 4; c++) {
+                this->a[c][k] = this->keyQ[c][ia];
+                this->b[c][k] = this->keyQ[c][ib];
+            }
+            this->u[k] = param;
+            this->theta[k] = this->segTheta[ia];
+            this->invSin[k] = this->segInvSin[ia];
+        }
+
+        // Passada 2: interpolação, 4 trilhas por vez
+        int i = 0;
+#ifdef ROTATION_SSE
+        const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4) {
+            __m128 t = _mm_loadu_ps(&this->u[i]);
+            __m128 wa = _mm_sub_ps(one, t), wb = t;
+            if (interp == ROTATION_SLERP) {
+                __m128 th = _mm_loadu_ps(&this->theta[i]), is = _mm_loadu_ps(&this->invSin[i]);
+                __m128 sa = _mm_mul_ps(sinHalfPi(_mm_mul_ps(th, wa)), is);
+                __m128 sb = _mm_mul_ps(sinHalfPi(_mm_mul_ps(th, t)), is);
+                // invSin == 0 (quadros-chave iguais): fica o lerp
+                __m128 usaLerp = _mm_cmpeq_ps(is, zero);
+                wa = _mm_or_ps(_mm_and_ps(usaLerp, wa), _mm_andnot_ps(usaLerp, sa));
+                wb = _mm_or_ps(_mm_and_ps(usaLerp, wb), _mm_andnot_ps(usaLerp, sb));
+            }
+            __m128 r[4], len2 = zero;
+            for (int c = 0; c < 4; c++) {
+                r[c] = _mm_add_ps(_mm_mul_ps(wa, _mm_loadu_ps(&this->a[c][i])),
+                                  _mm_mul_ps(wb, _mm_loadu_ps(&this->b[c][i])));
+                len2 = _mm_add_ps(len2, _mm_mul_ps(r[c], r[c]));
+            }
+            __m128 scale = interp == ROTATION_NLERP ? _mm_div_ps(one, _mm_sqrt_ps(len2)) : one;
+            for (int c = 0; c < 4; c++)
+                _mm_storeu_ps(&this->out[c][i], _mm_mul_ps(r[c], scale));
+        }
+#endif
+        this->interpolate(i, n, interp);
+    }
+
+    // Todas as trilhas no mesmo tempo
+    void sample(float time, RotationInterp interp = ROTATION_NLERP) {
+        this->u.assign(this->u.size(), time);
+        // u serve de array de tempos aqui: locate() lê o tempo antes de
+        // sample() escrever o parâmetro da mesma trilha
+        this->sample(this->u.data(), interp);
+    }
+
+    // Resultado da última amostra, um valor por trilha
+    const float *getW() const {
+        return this->out[0].data();
+    }
+
+    const float *getX() const {
+        return this->out[1].data();
+    }
+
+    const float *getY() const {
+        return this->out[2].data();
+    }
+
+    const float *getZ() const {
+        return this->out[3].data();
+    }
+
+    // Ângulo (radianos) de uma rotação em torno de z, como a de um sprite
+    float angleZ(int track) const {
+        return 2.0f * std::atan2(this->out[3][track], this->out[0][track]);
+    }
+};
+
+#endif /* RotationTracks_h */
@@ -20,14 +20,9 @@ public:
         targety = row * th / 2;
     }
     
+    // Losango exato, pelas mesmas contas de getPicker (o tamanho do mapa não importa aqui)
     void computeMouseMap(int &col, int &row, const float tw, const float th, const float mx, const float my) const {
-        float tw2 = tw / 2.0f;
-        float th2 = th / 2.0f;
-        
-        row = my / th2;
-        col = (mx - row * tw2) / tw;
-        // cout << "dest: " << col << "," << row << endl;
-
+        getPicker(tw, th, 0, 0).pick(mx, my, col, row);
     }
     
     void computeTileWalking(int &col, int &row, const int direction) const {
@@ -0,0 +1,251 @@
+//
+//  SpriteAnimator.h
+//
+//  Animação de sprites por clipes definidos em arquivo, no lugar de
+//  contadores de quadro escritos à mão em cada programa. Um clipe é uma
+//  sequência de quadros numa linha de uma folha de sprites (spritesheet),
+//  com fps e modo de repetição. O arquivo tem um clipe por linha:
+//
+//    # nome   folha  colunas linhas  linha  primeiro ultimo  fps  modo
+//    pulo     Jump   15      1       0      6        12      10   loop
+//
+//  colunas x linhas é a grade da folha; primeiro e ultimo são colunas
+//  (contadas de 0, inclusive); modo é loop, once (para no último quadro) ou
+//  pingpong (vai e volta). Linhas vazias e a partir de # são ignoradas.
+//
+//  O estado dos atores fica em arrays separados (clipe, tempo, quadro...), e
+//  update() anda todos num laço só. Cada ator guarda o tempo em que o quadro
+//  dele muda; no laço, só soma dt e compara, lendo 8 bytes por ator, e o
+//  quadro novo (com o modo do clipe) só é calculado quando o tempo chega lá:
+//  com milhares de atores, microssegundos por quadro. O resultado de cada ator
+//  é a coluna e a linha do quadro na folha, e o deslocamento de UV
+//  correspondente (getU(), getV()), que vai direto para o SpriteInstance do
+//  SpriteBatch.
+//
+
+#ifndef SpriteAnimator_h
+#define SpriteAnimator_h
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum AnimLoop {
+    ANIM_LOOP,
+    ANIM_ONCE,
+    ANIM_PINGPONG
+};
+
+struct AnimationClip {
+    std::string name, sheet;
+    int cols, rows;         // grade da folha
+    int row;                // linha dos quadros
+    int first, last;        // colunas do primeiro e do último quadro
+    float fps;
+    AnimLoop mode;
+};
+
+// Lê os clipes de path. Em caso de erro, devolve false e err diz a linha.
+inline bool loadAnimationClips(const std::string &path, std::vector<AnimationClip> &clips, std::string &err) {
+    std::ifstream in(path);
+    if (!in) {
+        err = "Não foi possível abrir o arquivo de animações: " + path;
+        return false;
+    }
+    clips.clear();
+    std::string line;
+    for (int lineNumber = 1; getline(in, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        AnimationClip c;
+        std::string mode;
+        if (!(iss >> c.name))
+            continue;
+        std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+        if (!(iss >> c.sheet >> c.cols >> c.rows >> c.row >> c.first >> c.last >> c.fps >> mode)) {
+            err = where + "esperado: nome folha colunas linhas linha primeiro ultimo fps modo";
+            return false;
+        }
+        if (mode == "loop")
+            c.mode = ANIM_LOOP;
+        else if (mode == "once")
+            c.mode = ANIM_ONCE;
+        else if (mode == "pingpong")
+            c.mode = ANIM_PINGPONG;
+        else {
+            err = where + "modo desconhecido: " + mode + " (loop, once ou pingpong)";
+            return false;
+        }
+        if (c.cols <= 0 || c.rows <= 0 || c.row < 0 || c.row >= c.rows || c.first < 0 || c.first > c.last ||
+            c.last >= c.cols) {
+            err = where + "quadros fora da grade da folha";
+            return false;
+        }
+        if (!(c.fps > 0.0f)) {
+            err = where + "fps deve ser maior que zero";
+            return false;
+        }
+        clips.push_back(c);
+    }
+    return true;
+}
+
+class SpriteAnimator {
+    // O que o laço de update() usa de cada clipe
+    struct ClipData {
+        float fps;
+        float duration;     // de uma volta (com pingpong, ida e volta)
+        int first, count;   // quadros
+        int mirror;         // pingpong: quadros da volta (f vira mirror - f na volta); senão, "infinito"
+        int row;
+        float du, dv;       // tamanho de um quadro em UV
+        bool once;
+    };
+
+    std::vector<AnimationClip> clips;
+    std::vector<ClipData> data;
+
+    // Atores
+    std::vector<int> clip;
+    std::vector<float> time;    // dentro da volta atual do clipe
+    std::vector<float> change;  // tempo (na volta) em que o quadro muda
+    std::vector<int> column, row;
+    std::vector<float> u, v;
+
+    // O tempo do ator chegou à mudança de quadro: quadro novo e próxima mudança
+    void changeFrame(int i) {
+        const ClipData &d = this->data[this->clip[i]];
+        float t = this->time[i];
+        // fim da volta: o tempo recomeça (ou para, no once), e não cresce sem limite
+        if (t >= d.duration) {
+            t = d.once ? d.duration : std::fmod(t, d.duration);
+            this->time[i] = t;
+        }
+        int raw = (int)(t * d.fps);
+        int f = raw < d.mirror - raw ? raw : d.mirror - raw;
+        f = f < d.count - 1 ? f : d.count - 1;
+        float next = (raw + 1) / d.fps;
+        if (d.once && raw >= d.count - 1)
+            next = HUGE_VALF; // parado no último quadro
+        this->change[i] = next < d.duration || d.once ? next : d.duration;
+        this->column[i] = d.first + f;
+        this->row[i] = d.row;
+        this->u[i] = this->column[i] * d.du;
+        this->v[i] = d.row * d.dv;
+    }
+
+public:
+    SpriteAnimator(const std::vector<AnimationClip> &clips) {
+        this->clips = clips;
+        for (const AnimationClip &c : clips) {
+            ClipData d;
+            d.fps = c.fps;
+            d.first = c.first;
+            d.count = c.last - c.first + 1;
+            int period = d.count;
+            d.mirror = 1 << 30;
+            if (c.mode == ANIM_PINGPONG && d.count > 1) {
+                period = 2 * d.count - 2;
+                d.mirror = period;
+            }
+            d.duration = period / c.fps;
+            d.row = c.row;
+            d.du = 1.0f / c.cols;
+            d.dv = 1.0f / c.rows;
+            d.once = c.mode == ANIM_ONCE;
+            this->data.push_back(d);
+        }
+    }
+
+    // Índice do clipe com esse nome, ou -1
+    int findClip(const std::string &name) const {
+        for (size_t i = 0; i < this->clips.size(); i++)
+            if (this->clips[i].name == name)
+                return (int)i;
+        return -1;
+    }
+
+    const AnimationClip &getClip(int c) const {
+        return this->clips[c];
+    }
+
+    // Novo ator tocando o clipe c, já no tempo t; devolve o índice dele
+    int add(int c, float t = 0.0f) {
+        int actor = (int)this->clip.size();
+        this->clip.push_back(c);
+        this->time.push_back(0.0f);
+        this->change.push_back(0.0f);
+        this->column.push_back(0);
+        this->row.push_back(0);
+        this->u.push_back(0.0f);
+        this->v.push_back(0.0f);
+        this->update(actor, actor + 1, t);
+        return actor;
+    }
+
+    int getActors() const {
+        return (int)this->clip.size();
+    }
+
+    // Troca o clipe do ator; o mesmo clipe continua de onde estava
+    void play(int actor, int c) {
+        if (this->clip[actor] == c)
+            return;
+        this->clip[actor] = c;
+        this->time[actor] = 0.0f;
+        this->change[actor] = 0.0f;
+        this->update(actor, actor + 1, 0.0f);
+    }
+
+    // Clipe once que já chegou ao último quadro
+    bool finished(int actor) const {
+        const ClipData &d = this->data[this->clip[actor]];
+        return d.once && this->time[actor] >= d.duration;
+    }
+
+    // Anda dt segundos em todos os atores
+    void update(float dt) {
+        this->update(0, this->getActors(), dt);
+    }
+
+    // Anda dt segundos nos atores [begin, end)
+    void update(int begin, int end, float dt) {
+        float *time = this->time.data();
+        const float *change = this->change.data();
+        for (int i = begin; i < end; i++) {
+            float t = time[i] + dt;
+            time[i] = t;
+            if (t >= change[i])
+                this->changeFrame(i);
+        }
+    }
+
+    // Quadro atual de cada ator: coluna e linha na folha
+    const int *getColumn() const {
+        return this->column.data();
+    }
+
+    const int *getRow() const {
+        return this->row.data();
+    }
+
+    // Canto do quadro atual na folha, em UV (v = 0 na linha de cima)
+    const float *getU() const {
+        return this->u.data();
+    }
+
+    const float *getV() const {
+        return this->v.data();
+    }
+
+    // Tamanho de um quadro do clipe do ator, em UV
+    void getFrameSize(int actor, float &du, float &dv) const {
+        const ClipData &d = this->data[this->clip[actor]];
+        du = d.du;
+        dv = d.dv;
+    }
+};
+
+#endif /* SpriteAnimator_h */
@@ -0,0 +1,267 @@
+//
+//  SpriteBatch.h
+//
+//  Desenho de sprites em lote. Cada quadro, os sprites são adicionados com
+//  add() e, em end(), ordenados por (camada, shader, textura), enviados de uma
+//  vez num buffer de instâncias e desenhados com um glDrawArraysInstanced por
+//  grupo de mesma textura. Assim o custo cresce com o número de sprites, e
+//  não com o número de chamadas (glUseProgram, uniforms, binds) por sprite.
+//
+//  A camada é a única garantia de ordem: dentro dela os sprites saem
+//  agrupados por shader e textura, não na ordem de add(). Um fundo que deve
+//  ficar atrás de tudo precisa de uma camada menor que a dos sprites.
+//
+//  Um shader próprio pode ser passado em add(); ele precisa usar o mesmo
+//  layout de atributos do shader padrão (locations 0 a 4), a uniform "proj"
+//  e o sampler "texture1".
+//
+
+#ifndef SpriteBatch_h
+#define SpriteBatch_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+struct SpriteInstance {
+    glm::vec2 position;      // centro
+    glm::vec2 dimensions;
+    glm::vec2 uv_min, uv_max; // retângulo do quadro 0 no spritesheet
+    glm::vec2 offset;        // deslocamento extra de UV (ex.: rolagem de fundo)
+    float frame;             // quadro atual: anda (uv_max.x - uv_min.x) * frame na horizontal
+
+    SpriteInstance(glm::vec2 position = glm::vec2(0.0f), glm::vec2 dimensions = glm::vec2(1.0f),
+                   glm::vec2 uv_min = glm::vec2(0.0f), glm::vec2 uv_max = glm::vec2(1.0f),
+                   glm::vec2 offset = glm::vec2(0.0f), float frame = 0.0f) :
+        position(position), dimensions(dimensions), uv_min(uv_min), uv_max(uv_max),
+        offset(offset), frame(frame) {}
+};
+
+class SpriteBatch {
+    // Dados por instância, na ordem dos atributos 2, 3 e 4 do shader
+    struct InstanceData {
+        float rect[4];  // centro.xy, dimensões.zw
+        float uv[4];    // uv_min.xy, uv_max.zw
+        float anim[4];  // offset.xy, quadro, (livre)
+    };
+
+    struct Entry {
+        int layer;
+        GLuint shader, texture;
+        InstanceData data;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<InstanceData> instances;
+    GLuint vao, quadVBO, instanceVBO;
+    size_t capacity;          // instâncias que cabem no instanceVBO
+    GLuint defaultShader;
+    int drawCalls;            // draws do último end()
+
+    static GLuint compile(GLenum type, const char *src) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::SPRITEBATCH::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    void setupShader() {
+        const char *vertex_shader_src =
+            "#version 410 core\n"
+            "layout(location = 0) in vec2 aPos;\n"
+            "layout(location = 1) in vec2 aTexCoord;\n"
+            "layout(location = 2) in vec4 iRect;\n"
+            "layout(location = 3) in vec4 iUV;\n"
+            "layout(location = 4) in vec4 iAnim;\n"
+            "uniform mat4 proj;\n"
+            "out vec2 TexCoord;\n"
+            "void main() {\n"
+            "    vec2 frameStep = vec2((iUV.z - iUV.x) * iAnim.z, 0.0);\n"
+            "    TexCoord = mix(iUV.xy, iUV.zw, aTexCoord) + frameStep + iAnim.xy;\n"
+            "    gl_Position = proj * vec4(iRect.xy + aPos * iRect.zw, 0.0, 1.0);\n"
+            "}\n";
+
+        const char *fragment_shader_src =
+            "#version 410 core\n"
+            "in vec2 TexCoord;\n"
+            "uniform sampler2D texture1;\n"
+            "out vec4 FragColor;\n"
+            "void main() {\n"
+            "    FragColor = texture(texture1, TexCoord);\n"
+            "}\n";
+
+        GLuint vs = compile(GL_VERTEX_SHADER, vertex_shader_src);
+        GLuint fs = compile(GL_FRAGMENT_SHADER, fragment_shader_src);
+        this->defaultShader = glCreateProgram();
+        glAttachShader(this->defaultShader, vs);
+        glAttachShader(this->defaultShader, fs);
+        glLinkProgram(this->defaultShader);
+        GLint success;
+        glGetProgramiv(this->defaultShader, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(this->defaultShader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::SPRITEBATCH::LINKING_FAILED\n" << infoLog << std::endl;
+        }
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+    }
+
+    // Aponta os atributos de instância para o início do grupo `first`
+    void bindInstances(size_t first) {
+        size_t stride = sizeof(InstanceData);
+        size_t base = first * stride;
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        for (int i = 0; i < 3; i++) {
+            glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, stride, (void *)(base + i * 4 * sizeof(float)));
+        }
+    }
+
+public:
+    SpriteBatch() {
+        this->vao = this->quadVBO = this->instanceVBO = 0;
+        this->capacity = 0;
+        this->defaultShader = 0;
+        this->drawCalls = 0;
+    }
+
+    ~SpriteBatch() {
+        if (this->vao) {
+            glDeleteVertexArrays(1, &this->vao);
+            glDeleteBuffers(1, &this->quadVBO);
+            glDeleteBuffers(1, &this->instanceVBO);
+            glDeleteProgram(this->defaultShader);
+        }
+    }
+
+    // Cria o VAO, os buffers e o shader padrão; precisa de um contexto GL ativo
+    void init() {
+        setupShader();
+
+        // quad unitário centrado na origem: (x, y, s, t), t = 0 em cima
+        float vertices[] = {
+            -0.5f, -0.5f, 0.f, 1.f,
+             0.5f, -0.5f, 1.f, 1.f,
+             0.5f,  0.5f, 1.f, 0.f,
+
+            -0.5f, -0.5f, 0.f, 1.f,
+             0.5f,  0.5f, 1.f, 0.f,
+            -0.5f,  0.5f, 0.f, 0.f
+        };
+
+        glGenVertexArrays(1, &this->vao);
+        glBindVertexArray(this->vao);
+
+        glGenBuffers(1, &this->quadVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        glGenBuffers(1, &this->instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        for (int i = 0; i < 3; i++) {
+            glEnableVertexAttribArray(2 + i);
+            glVertexAttribDivisor(2 + i, 1);
+        }
+        bindInstances(0);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLuint getShader() {
+        return this->defaultShader;
+    }
+
+    int getDrawCalls() {
+        return this->drawCalls;
+    }
+
+    void begin() {
+        this->entries.clear();
+    }
+
+    // Camadas menores são desenhadas antes; dentro de uma camada a ordem é por
+    // (shader, textura), e só sprites de mesmo shader e textura mantêm a ordem de add()
+    void add(GLuint texture, const SpriteInstance &s, int layer = 0, GLuint shader = 0) {
+        Entry e;
+        e.layer = layer;
+        e.shader = shader ? shader : this->defaultShader;
+        e.texture = texture;
+        InstanceData &d = e.data;
+        d.rect[0] = s.position.x;   d.rect[1] = s.position.y;
+        d.rect[2] = s.dimensions.x; d.rect[3] = s.dimensions.y;
+        d.uv[0] = s.uv_min.x;       d.uv[1] = s.uv_min.y;
+        d.uv[2] = s.uv_max.x;       d.uv[3] = s.uv_max.y;
+        d.anim[0] = s.offset.x;     d.anim[1] = s.offset.y;
+        d.anim[2] = s.frame;        d.anim[3] = 0.0f;
+        this->entries.push_back(e);
+    }
+
+    void end(const glm::mat4 &proj) {
+        this->drawCalls = 0;
+        if (this->entries.empty())
+            return;
+
+        std::stable_sort(this->entries.begin(), this->entries.end(), [](const Entry &a, const Entry &b) {
+            if (a.layer != b.layer) return a.layer < b.layer;
+            if (a.shader != b.shader) return a.shader < b.shader;
+            return a.texture < b.texture;
+        });
+
+        this->instances.resize(this->entries.size());
+        for (size_t i = 0; i < this->entries.size(); i++)
+            this->instances[i] = this->entries[i].data;
+
+        // orphaning: buffer novo a cada quadro, sem esperar a GPU terminar o anterior
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        if (this->instances.size() > this->capacity)
+            this->capacity = std::max(this->instances.size(), this->capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, this->instances.size() * sizeof(InstanceData), this->instances.data());
+
+        glBindVertexArray(this->vao);
+        glActiveTexture(GL_TEXTURE0);
+
+        GLuint currentShader = 0;
+        size_t first = 0;
+        while (first < this->entries.size()) {
+            const Entry &e = this->entries[first];
+            size_t last = first + 1;
+            while (last < this->entries.size() && this->entries[last].layer == e.layer &&
+                   this->entries[last].shader == e.shader && this->entries[last].texture == e.texture)
+                last++;
+
+            if (e.shader != currentShader) {
+                currentShader = e.shader;
+                glUseProgram(currentShader);
+                glUniformMatrix4fv(glGetUniformLocation(currentShader, "proj"), 1, GL_FALSE, glm::value_ptr(proj));
+                glUniform1i(glGetUniformLocation(currentShader, "texture1"), 0);
+            }
+            glBindTexture(GL_TEXTURE_2D, e.texture);
+            bindInstances(first);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, last - first);
+            this->drawCalls++;
+
+            first = last;
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+#endif /* SpriteBatch_h */
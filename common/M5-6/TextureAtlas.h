@@ -0,0 +1,354 @@
+//
+//  TextureAtlas.h
+//
+//  Junta várias imagens em uma ou poucas texturas grandes (páginas) e guarda
+//  uma tabela nome -> retângulo. Assim sprites, tiles e moedas podem usar a
+//  mesma textura, e quem desenha só troca o retângulo de UV em vez de fazer
+//  glBindTexture a cada objeto.
+//
+//  Dois jeitos de usar:
+//   - na inicialização: add() para cada PNG, pack() e upload();
+//   - offline: o mesmo, mas save() grava as páginas em PNG e a tabela em
+//     texto (ver src/Ferramentas/GeraAtlas.cpp); no jogo, load() + upload(),
+//     ou loadTable() e as páginas carregadas à parte (p. ex. pelo AssetLoader)
+//     e entregues com setPageTexture().
+//
+//  As imagens são empacotadas em prateleiras (mais altas primeiro), com uma
+//  borda de ATLAS_PADDING pixels que repete a beirada de cada imagem, para que a
+//  filtragem não misture imagens vizinhas.
+//
+//  UVs seguem a convenção do OpenGL para a textura enviada: s da esquerda
+//  para a direita, t = 0 na primeira linha da imagem (topo do PNG).
+//
+//  Precisa de stb_image.h (STB_IMAGE_IMPLEMENTATION em algum .cpp). save()
+//  só existe se stb_image_write.h for incluído antes deste arquivo.
+//
+
+#ifndef TextureAtlas_h
+#define TextureAtlas_h
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define ATLAS_PADDING 1
+
+// (std::min) e (std::max) entre parênteses: o windows.h define min e max como macros
+
+struct AtlasRegion {
+    int page;               // página (textura) do atlas
+    int x, y, w, h;         // em pixels, sem a borda
+    float u0, v0, u1, v1;   // (u0, v0) canto superior esquerdo, (u1, v1) inferior direito
+};
+
+class TextureAtlas {
+    struct Image {
+        std::string name;
+        int w, h;
+        std::vector<unsigned char> rgba;
+    };
+
+    struct Page {
+        int w, h;
+        std::vector<unsigned char> rgba; // vazio depois de upload() sem keepPixels
+        GLuint tid;
+    };
+
+    std::vector<Image> pending;   // adicionadas e ainda não empacotadas
+    std::vector<Page> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+    int maxSize;
+
+    // Copia a imagem para (x, y) da página e repete a beirada na borda
+    static void blit(Page &page, const Image &img, int x, int y) {
+        for (int py = -ATLAS_PADDING; py < img.h + ATLAS_PADDING; py++) {
+            int sy = (std::min)((std::max)(py, 0), img.h - 1);
+            for (int px = -ATLAS_PADDING; px < img.w + ATLAS_PADDING; px++) {
+                int sx = (std::min)((std::max)(px, 0), img.w - 1);
+                memcpy(&page.rgba[((y + py) * page.w + (x + px)) * 4], &img.rgba[(sy * img.w + sx) * 4], 4);
+            }
+        }
+    }
+
+    void computeUV(AtlasRegion &r) {
+        const Page &page = this->pages[r.page];
+        r.u0 = (float)r.x / page.w;
+        r.v0 = (float)r.y / page.h;
+        r.u1 = (float)(r.x + r.w) / page.w;
+        r.v1 = (float)(r.y + r.h) / page.h;
+    }
+
+    void computeUVs(int page) {
+        for (auto &it : this->regions)
+            if (it.second.page == page)
+                computeUV(it.second);
+    }
+
+public:
+    TextureAtlas(int maxSize = 4096) {
+        this->maxSize = maxSize;
+    }
+
+    ~TextureAtlas() {
+        for (Page &page : this->pages)
+            if (page.tid)
+                glDeleteTextures(1, &page.tid);
+    }
+
+    // O destrutor apaga as texturas das páginas: uma cópia apagaria os mesmos nomes duas vezes
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // Carrega um PNG (sempre como RGBA) para o próximo pack()
+    bool add(const std::string &name, const std::string &path) {
+        int w, h, n;
+        unsigned char *data = stbi_load(path.c_str(), &w, &h, &n, 4);
+        if (!data) {
+            std::cerr << "TextureAtlas: falha ao carregar " << path << std::endl;
+            return false;
+        }
+        add(name, data, w, h);
+        stbi_image_free(data);
+        return true;
+    }
+
+    void add(const std::string &name, const unsigned char *rgba, int w, int h) {
+        Image img;
+        img.name = name;
+        img.w = w;
+        img.h = h;
+        img.rgba.assign(rgba, rgba + w * h * 4);
+        this->pending.push_back(img);
+    }
+
+    // Empacota as imagens pendentes em páginas novas de até maxSize x maxSize.
+    // A largura da página é a potência de 2 que deixa o atlas mais próximo de
+    // um quadrado; a altura é só a usada.
+    bool pack() {
+        if (this->pending.empty())
+            return true;
+
+        std::stable_sort(this->pending.begin(), this->pending.end(), [](const Image &a, const Image &b) {
+            return a.h > b.h;
+        });
+
+        long area = 0;
+        int widest = 0;
+        for (const Image &img : this->pending) {
+            int w = img.w + 2 * ATLAS_PADDING, h = img.h + 2 * ATLAS_PADDING;
+            if (w > this->maxSize || h > this->maxSize) {
+                std::cerr << "TextureAtlas: " << img.name << " (" << img.w << "x" << img.h
+                          << ") não cabe em " << this->maxSize << "x" << this->maxSize << std::endl;
+                return false;
+            }
+            area += (long)w * h;
+            widest = (std::max)(widest, w);
+        }
+        int pageW = 1;
+        while (pageW < widest || (long)pageW * pageW < area)
+            pageW *= 2;
+        pageW = (std::min)(pageW, this->maxSize);
+
+        // posições: primeiro decide tudo, depois aloca as páginas com a altura certa
+        struct Place { int page, x, y; };
+        std::vector<Place> places(this->pending.size());
+        std::vector<int> pageHeights(1, 0);
+        int x = 0, y = 0, shelfH = 0;
+        for (size_t i = 0; i < this->pending.size(); i++) {
+            int w = this->pending[i].w + 2 * ATLAS_PADDING, h = this->pending[i].h + 2 * ATLAS_PADDING;
+            if (x + w > pageW) { // prateleira nova
+                x = 0;
+                y += shelfH;
+                shelfH = 0;
+            }
+            if (y + h > this->maxSize) { // página nova
+                pageHeights.push_back(0);
+                x = y = shelfH = 0;
+            }
+            places[i].page = (int)(this->pages.size() + pageHeights.size() - 1);
+            places[i].x = x + ATLAS_PADDING;
+            places[i].y = y + ATLAS_PADDING;
+            x += w;
+            shelfH = (std::max)(shelfH, h);
+            pageHeights.back() = (std::max)(pageHeights.back(), y + h);
+        }
+
+        for (int h : pageHeights) {
+            Page page;
+            page.w = pageW;
+            page.h = h;
+            page.rgba.assign((size_t)pageW * h * 4, 0);
+            page.tid = 0;
+            this->pages.push_back(page);
+        }
+
+        for (size_t i = 0; i < this->pending.size(); i++) {
+            const Image &img = this->pending[i];
+            AtlasRegion r;
+            r.page = places[i].page;
+            r.x = places[i].x;
+            r.y = places[i].y;
+            r.w = img.w;
+            r.h = img.h;
+            blit(this->pages[r.page], img, r.x, r.y);
+            computeUV(r);
+            this->regions[img.name] = r;
+        }
+        this->pending.clear();
+        return true;
+    }
+
+    // Cria uma textura por página. Sem keepPixels, libera a cópia na CPU.
+    void upload(GLint filter = GL_NEAREST, bool keepPixels = false) {
+        for (Page &page : this->pages) {
+            if (page.tid || page.rgba.empty())
+                continue;
+            glGenTextures(1, &page.tid);
+            glBindTexture(GL_TEXTURE_2D, page.tid);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page.w, page.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, page.rgba.data());
+            if (!keepPixels)
+                std::vector<unsigned char>().swap(page.rgba);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // NULL se o nome não está no atlas
+    const AtlasRegion *find(const std::string &name) const {
+        std::unordered_map<std::string, AtlasRegion>::const_iterator it = this->regions.find(name);
+        return it == this->regions.end() ? NULL : &it->second;
+    }
+
+    GLuint getTexture(int page = 0) const {
+        return page < (int)this->pages.size() ? this->pages[page].tid : 0;
+    }
+
+    GLuint getTexture(const AtlasRegion &r) const {
+        return getTexture(r.page);
+    }
+
+    int getPageCount() const {
+        return (int)this->pages.size();
+    }
+
+    int getRegionCount() const {
+        return (int)this->regions.size();
+    }
+
+    // Lê um atlas gravado por save(): <base>.txt e <base>_<página>.png
+    bool load(const std::string &base) {
+        size_t first = this->pages.size();
+        std::vector<std::string> pagePaths;
+        if (!loadTable(base, pagePaths))
+            return false;
+
+        for (size_t p = 0; p < pagePaths.size(); p++) {
+            int w, h, n;
+            unsigned char *data = stbi_load(pagePaths[p].c_str(), &w, &h, &n, 4);
+            if (!data) { // desfaz a tabela lida
+                this->pages.resize(first);
+                for (auto it = this->regions.begin(); it != this->regions.end();)
+                    it = it->second.page >= (int)first ? this->regions.erase(it) : std::next(it);
+                return false;
+            }
+            Page &page = this->pages[first + p];
+            page.w = w;
+            page.h = h;
+            page.rgba.assign(data, data + w * h * 4);
+            stbi_image_free(data);
+            computeUVs((int)(first + p));
+        }
+        return true;
+    }
+
+    // Só a tabela <base>.txt: as páginas novas ficam sem pixels nem textura, e as
+    // UVs das regiões delas só valem depois de setPageTexture(). pagePaths recebe
+    // o PNG de cada página nova, na ordem.
+    bool loadTable(const std::string &base, std::vector<std::string> &pagePaths) {
+        std::ifstream in(base + ".txt");
+        if (!in)
+            return false;
+
+        std::string tag;
+        int nPages;
+        if (!(in >> tag >> nPages) || tag != "atlas")
+            return false;
+
+        size_t first = this->pages.size();
+        for (int p = 0; p < nPages; p++) {
+            char path[16];
+            snprintf(path, sizeof(path), "_%d.png", p);
+            pagePaths.push_back(base + path);
+            Page page;
+            page.w = page.h = 0;
+            page.tid = 0;
+            this->pages.push_back(page);
+        }
+
+        std::string name;
+        AtlasRegion r;
+        while (in >> name >> r.page >> r.x >> r.y >> r.w >> r.h) {
+            r.page += (int)first;
+            r.u0 = r.v0 = r.u1 = r.v1 = 0.0f;
+            this->regions[name] = r;
+        }
+        return true;
+    }
+
+    // Textura de uma página criada fora do atlas, que passa a ser dono dela
+    void setPageTexture(int page, GLuint tid, int w, int h) {
+        Page &p = this->pages[page];
+        if (p.tid && p.tid != tid)
+            glDeleteTextures(1, &p.tid);
+        p.tid = tid;
+        p.w = w;
+        p.h = h;
+        std::vector<unsigned char>().swap(p.rgba);
+        computeUVs(page);
+    }
+
+#ifdef INCLUDE_STB_IMAGE_WRITE_H
+    // Grava <base>_<página>.png e a tabela <base>.txt ("nome página x y w h" por linha)
+    bool save(const std::string &base) const {
+        for (size_t p = 0; p < this->pages.size(); p++) {
+            const Page &page = this->pages[p];
+            if (page.rgba.empty()) {
+                std::cerr << "TextureAtlas: página " << p << " já foi liberada por upload()" << std::endl;
+                return false;
+            }
+            char path[16];
+            snprintf(path, sizeof(path), "_%d.png", (int)p);
+            if (!stbi_write_png((base + path).c_str(), page.w, page.h, 4, page.rgba.data(), page.w * 4))
+                return false;
+        }
+
+        std::ofstream out(base + ".txt");
+        if (!out)
+            return false;
+        out << "atlas " << this->pages.size() << "\n";
+        std::vector<std::string> names; // em ordem alfabética, para o arquivo não mudar à toa
+        for (const auto &it : this->regions)
+            names.push_back(it.first);
+        std::sort(names.begin(), names.end());
+        for (const std::string &name : names) {
+            const AtlasRegion &r = this->regions.at(name);
+            out << name << " " << r.page << " " << r.x << " " << r.y << " " << r.w << " " << r.h << "\n";
+        }
+        return (bool)out;
+    }
+#endif
+};
+
+#endif /* TextureAtlas_h */
@@ -1,3 +1,8 @@
+#ifndef TileMap_h
+#define TileMap_h
+
+#include <cstring>
+
 class TileMap {
     float z;               // caso de eventual de vários tilemaps sobrepostos
     unsigned int tid;      // indicação do tileset utilizado
@@ -8,23 +13,20 @@ class TileMap {
 public:
     TileMap(int w, int h, unsigned char initWith) {
         this->map = new unsigned char [w*h];
+        memset(this->map, initWith, w*h);
         this->width = w;
         this->height = h;
         this->z = 0.0f;
         this->tid = 0;
     }
+
+    ~TileMap() {
+        delete [] this->map;
+    }
     
-//    TileMap(const TileMap &tm) {
-//        map = new unsigned char[tm.width * tm.height];
-//        this->width = tm.width;
-//        this->height = tm.height;
-//        this->z = tm.z;
-//        this->tid = tm.tid;
-////        for (int i=0; this->width * this->height; i++) {
-////            this->map[i] = tm.map[i];
-////        }
-//        memcpy(this->map, tm.map, tm.width*tm.height);
-//    }
+    // O destrutor libera map: uma cópia rasa liberaria o mesmo vetor duas vezes
+    TileMap(const TileMap &) = delete;
+    TileMap &operator=(const TileMap &) = delete;
     
     unsigned char* getMap() {
         return this->map;
@@ -64,3 +66,4 @@ public:
     
 };
 
+#endif /* TileMap_h */
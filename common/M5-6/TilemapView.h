@@ -18,11 +18,152 @@
 #define DIRECTION_SOUTHEAST 7
 #define DIRECTION_SOUTHWEST 8
 
+#include <vector>
+#include <cmath>
+
+// Colunas [colBegin, colEnd) visíveis de uma linha do mapa
+struct TileSpan {
+    int row, colBegin, colEnd;
+};
+
+// Tile sob um ponto (no espaço de computeDrawPosition), sem alocar nada e sem
+// teste de triângulo: os tiles são losangos tw x th encaixados sem sobra, então
+// o ponto vira coordenadas (s, t) nos eixos do losango, em que cada tile ocupa
+// [S - 1/2, S + 1/2) x [T - 1/2, T + 1/2) com S e T inteiros. São dois floor;
+// o resto é conta inteira para passar de (S, T) para (col, row).
+// Ponto em cima da borda entre dois tiles fica com o de S (ou T) maior: nenhum
+// ponto fica sem tile nem cai em dois. Criado por TilemapView::getPicker.
+struct TilePicker {
+    float ox, oy;           // centro do tile (0, 0)
+    float ka, kb;           // 2/tw e 2/th
+    int i00, i01, i10, i11; // col = i00*S + i01*T ; row = i10*S + i11*T
+    int cols, rows;         // 0 se a visão não encaixa os losangos assim
+
+    // false se o ponto estiver fora do mapa (col e row ficam com o tile de
+    // fora, como em computeMouseMap)
+    bool pick(const float px, const float py, int &col, int &row) const {
+        float a = (px - this->ox) * this->ka;
+        float b = (py - this->oy) * this->kb;
+        int S = (int) floorf((a + b) * 0.5f + 0.5f);
+        int T = (int) floorf((a - b) * 0.5f + 0.5f);
+        col = this->i00 * S + this->i01 * T;
+        row = this->i10 * S + this->i11 * T;
+        return (unsigned) col < (unsigned) this->cols && (unsigned) row < (unsigned) this->rows;
+    }
+
+    // n pontos (x, y intercalados em xy): tiles[k] = row * cols + col, ou -1 fora do mapa
+    void pick(const float *xy, const int n, int *tiles) const {
+        for (int k = 0; k < n; k++) {
+            int col, row;
+            bool inside = pick(xy[2 * k], xy[2 * k + 1], col, row);
+            tiles[k] = inside ? row * this->cols + col : -1;
+        }
+    }
+};
+
 class TilemapView {
 public:
     virtual void computeDrawPosition(const int col, const int row, const float tw, const float th, float &targetx, float &targety) const = 0;
     virtual void computeMouseMap(int &col, int &row, const float tw, const float th, const float mx, const float my) const = 0;
     virtual void computeTileWalking(int &col, int &row, const int direction) const = 0;
+
+    // Seleção exata para um mapa cols x rows com tiles tw x th (ver TilePicker).
+    // Chama computeDrawPosition três vezes: para muitos pontos, guarde o picker.
+    TilePicker getPicker(const float tw, const float th, const int cols, const int rows) const {
+        TilePicker p;
+        float x0, y0, x1, y1, x2, y2;
+        computeDrawPosition(0, 0, tw, th, x0, y0);
+        computeDrawPosition(1, 0, tw, th, x1, y1);
+        computeDrawPosition(0, 1, tw, th, x2, y2);
+        p.ox = x0 + tw / 2.0f;
+        p.oy = y0 + th / 2.0f;
+        p.ka = 2.0f / tw;
+        p.kb = 2.0f / th;
+
+        // (S, T) de um passo em col e de um passo em row
+        float ac = (x1 - x0) * p.ka, bc = (y1 - y0) * p.kb;
+        float ar = (x2 - x0) * p.ka, br = (y2 - y0) * p.kb;
+        int sc = (int) lroundf((ac + bc) / 2.0f), tc = (int) lroundf((ac - bc) / 2.0f);
+        int sr = (int) lroundf((ar + br) / 2.0f), tr = (int) lroundf((ar - br) / 2.0f);
+        int det = sc * tr - sr * tc;
+
+        // inversa inteira só existe com det = ±1 (1/det = det)
+        p.i00 = tr * det;
+        p.i01 = -sr * det;
+        p.i10 = -tc * det;
+        p.i11 = sc * det;
+        bool fits = det == 1 || det == -1;
+        p.cols = fits ? cols : 0;
+        p.rows = fits ? rows : 0;
+        return p;
+    }
+
+    // Linhas e colunas dos tiles cujo retângulo [x, x+tw] x [y, y+th] cruza o retângulo da câmera
+    // [minx, maxx] x [miny, maxy], no mesmo espaço de computeDrawPosition.
+    // Vale para qualquer visão em que a posição é afim em (col, row), como diamond e slide:
+    // a câmera vira um paralelogramo no espaço (col, row), que é recortado linha a linha.
+    void computeVisibleSpans(const float tw, const float th, const float minx, const float miny, const float maxx, const float maxy,
+                             const int cols, const int rows, std::vector<TileSpan> &spans) const {
+        spans.clear();
+
+        // x(c, r) = ox + c*xc + r*xr ; y(c, r) = oy + c*yc + r*yr
+        float ox, oy, x1, y1, x2, y2;
+        computeDrawPosition(0, 0, tw, th, ox, oy);
+        computeDrawPosition(1, 0, tw, th, x1, y1);
+        computeDrawPosition(0, 1, tw, th, x2, y2);
+        float xc = x1 - ox, yc = y1 - oy;
+        float xr = x2 - ox, yr = y2 - oy;
+
+        // faixas abertas em que o canto (x, y) do tile precisa estar
+        float xlo = minx - tw - ox, xhi = maxx - ox;
+        float ylo = miny - th - oy, yhi = maxy - oy;
+
+        // faixa de linhas: inverte os 4 cantos do paralelogramo
+        int rowBegin = 0, rowEnd = rows;
+        float det = xc * yr - xr * yc;
+        if (det != 0.0f) {
+            float rmin = INFINITY, rmax = -INFINITY;
+            float xs[] = {xlo, xhi}, ys[] = {ylo, yhi};
+            for (float x : xs) {
+                for (float y : ys) {
+                    float r = (xc * y - yc * x) / det;
+                    rmin = fmin(rmin, r);
+                    rmax = fmax(rmax, r);
+                }
+            }
+            rowBegin = (int) fmax(0.0f, floor(rmin));
+            rowEnd = (int) fmin((float) rows, ceil(rmax) + 1.0f);
+        }
+
+        for (int r = rowBegin; r < rowEnd; r++) {
+            float cmin = -1.0f, cmax = (float) cols;
+            if (!clipAxis(xc, xlo - r * xr, xhi - r * xr, cmin, cmax) ||
+                !clipAxis(yc, ylo - r * yr, yhi - r * yr, cmin, cmax))
+                continue;
+
+            // colunas inteiras com cmin < c < cmax
+            TileSpan span;
+            span.row = r;
+            span.colBegin = (int) floor(cmin) + 1;
+            span.colEnd = (int) ceil(cmax);
+            if (span.colBegin < span.colEnd)
+                spans.push_back(span);
+        }
+    }
+
+private:
+    // Restringe [cmin, cmax] aos c com lo < k*c < hi; falso se não sobrar nada
+    static bool clipAxis(const float k, const float lo, const float hi, float &cmin, float &cmax) {
+        if (k == 0.0f)
+            return lo < 0.0f && 0.0f < hi;
+        float a = lo / k, b = hi / k;
+        if (k < 0.0f) {
+            float t = a; a = b; b = t;
+        }
+        cmin = fmax(cmin, a);
+        cmax = fmin(cmax, b);
+        return cmin < cmax;
+    }
 };
 
 
@@ -0,0 +1,971 @@
+//
+//  TmxImporter.h
+//
+//  Leitura de mapas do Tiled (.tmx) sem carregar o XML inteiro: o arquivo é
+//  lido em blocos e os tiles de cada camada são decodificados conforme
+//  chegam e entregues linha a linha a um TmxListener. Suporta:
+//   - camadas em CSV, em base64 (sem compressão, zlib ou gzip) e no formato
+//     antigo de <tile gid="..."/>;
+//   - mapas infinitos (infinite="1"), cujas camadas vêm em <chunk>s.
+//  Compressão zstd não é suportada.
+//
+//  loadTileMaps() usa o importador para montar um TileMap por camada.
+//
+
+#ifndef TmxImporter_h
+#define TmxImporter_h
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TileMap.h"
+
+#define TMX_GID_MASK 0x0FFFFFFFu // sem os bits de espelhamento/rotação
+
+struct TmxMapInfo {
+    std::string orientation;
+    int width, height;      // em tiles (sem significado em mapas infinitos)
+    int tileW, tileH;       // em pixels
+    bool infinite;
+    std::vector<std::pair<unsigned int, std::string> > tilesets; // (firstgid, source ou name)
+};
+
+struct TmxLayerInfo {
+    int index;              // ordem da camada no arquivo, a partir de 0
+    std::string name;
+    int width, height;
+};
+
+// Uma camada já montada como TileMap (ver TmxImporter::loadTileMaps). (originX, originY)
+// é a posição no Tiled do tile (0, 0) do TileMap: sempre (0, 0) em mapas finitos.
+// O TileMap é de quem chamou loadTileMaps (delete quando não for mais usado).
+struct TmxTileLayer {
+    std::string name;
+    TileMap *tiles;
+    int originX, originY;
+};
+
+// Recebe o mapa conforme ele é lido. gids já vêm sem os bits de espelhamento; 0 = vazio.
+class TmxListener {
+public:
+    virtual ~TmxListener() {}
+    virtual bool map(const TmxMapInfo & /*info*/, std::string & /*err*/) { return true; }
+    virtual bool beginLayer(const TmxLayerInfo & /*layer*/, std::string & /*err*/) { return true; }
+    // n tiles consecutivos da linha y, a partir da coluna x (podem ser negativos em mapas infinitos)
+    virtual bool row(const TmxLayerInfo &layer, int x, int y, int n, const uint32_t *gids, std::string &err) = 0;
+    virtual bool endLayer(const TmxLayerInfo & /*layer*/, std::string & /*err*/) { return true; }
+};
+
+class TmxImporter {
+    // ---------------------------------------------------------------- XML
+    struct Tag {
+        std::string name;   // "/nome" para tags de fechamento
+        std::vector<std::pair<std::string, std::string> > attrs;
+        bool selfClosing;
+
+        std::string attr(const char *key, const char *def = "") const {
+            for (size_t i = 0; i < attrs.size(); i++)
+                if (attrs[i].first == key)
+                    return attrs[i].second;
+            return def;
+        }
+        int intAttr(const char *key, int def = 0) const {
+            std::string v = attr(key);
+            return v.empty() ? def : atoi(v.c_str());
+        }
+    };
+
+    class XmlStream {
+        FILE *f;
+        unsigned char buf[1 << 16];
+        size_t pos, len;
+
+    public:
+        XmlStream() : f(NULL), pos(0), len(0) {}
+        ~XmlStream() { if (f) fclose(f); }
+
+        bool open(const std::string &path) {
+            f = fopen(path.c_str(), "rb");
+            return f != NULL;
+        }
+
+        int peek() {
+            if (pos == len) {
+                len = f ? fread(buf, 1, sizeof(buf), f) : 0;
+                pos = 0;
+                if (len == 0)
+                    return -1;
+            }
+            return buf[pos];
+        }
+
+        int get() {
+            int c = peek();
+            if (c >= 0)
+                pos++;
+            return c;
+        }
+
+        // Próximo caractere que não é espaço (sem consumi-lo)
+        int peekNonSpace() {
+            int c;
+            while ((c = peek()) == ' ' || c == '\t' || c == '\r' || c == '\n')
+                get();
+            return c;
+        }
+
+        // Pula texto, comentários e declarações até a próxima tag
+        bool nextTag(Tag &tag) {
+            for (;;) {
+                int c;
+                while ((c = get()) >= 0 && c != '<') {}
+                if (c < 0)
+                    return false;
+                if (peek() == '?' || peek() == '!') {
+                    bool comment = get() == '!' && peek() == '-';
+                    int a = 0, b = 0;
+                    while ((c = get()) >= 0 && !(c == '>' && (!comment || (a == '-' && b == '-')))) {
+                        a = b;
+                        b = c;
+                    }
+                    continue;
+                }
+                break;
+            }
+
+            tag.name.clear();
+            tag.attrs.clear();
+            tag.selfClosing = false;
+            int c;
+            while ((c = peek()) >= 0 && c != '>' && c != '/' && !isSpace(c)) {
+                tag.name += (char)c;
+                get();
+            }
+            if (c == '/' && tag.name.empty()) { // </nome>
+                get();
+                tag.name = "/";
+                while ((c = peek()) >= 0 && c != '>' && !isSpace(c)) {
+                    tag.name += (char)c;
+                    get();
+                }
+            }
+            for (;;) {
+                c = peekNonSpace();
+                if (c < 0)
+                    return false;
+                if (c == '>') {
+                    get();
+                    return true;
+                }
+                if (c == '/') {
+                    get();
+                    tag.selfClosing = true;
+                    continue;
+                }
+                std::string key, value;
+                while ((c = peek()) >= 0 && c != '=' && c != '>' && !isSpace(c)) {
+                    key += (char)c;
+                    get();
+                }
+                if (peekNonSpace() != '=')
+                    continue;
+                get();
+                int quote = peekNonSpace();
+                if (quote != '"' && quote != '\'')
+                    return false;
+                get();
+                while ((c = get()) >= 0 && c != quote)
+                    value += (char)c;
+                tag.attrs.push_back(std::make_pair(key, unescape(value)));
+            }
+        }
+
+        static bool isSpace(int c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static std::string unescape(const std::string &s) {
+            if (s.find('&') == std::string::npos)
+                return s;
+            static const char *ent[][2] = {{"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}};
+            std::string r;
+            for (size_t i = 0; i < s.size();) {
+                bool found = false;
+                for (int e = 0; e < 5 && !found; e++) {
+                    size_t n = strlen(ent[e][0]);
+                    if (s.compare(i, n, ent[e][0]) == 0) {
+                        r += ent[e][1];
+                        i += n;
+                        found = true;
+                    }
+                }
+                if (!found)
+                    r += s[i++];
+            }
+            return r;
+        }
+    };
+
+    // ---------------------------------------------------------------- bytes
+    // Fonte de bytes puxada sob demanda; -1 no fim ou em erro
+    class ByteSource {
+    public:
+        bool error;
+        ByteSource() : error(false) {}
+        virtual ~ByteSource() {}
+        virtual int next() = 0;
+    };
+
+    // Decodifica o texto base64 do XML até o próximo '<'
+    class Base64Source : public ByteSource {
+        XmlStream &xml;
+        unsigned char out[3];
+        int pos, count;
+
+        static int value(int c) {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        }
+
+    public:
+        Base64Source(XmlStream &xml) : xml(xml), pos(0), count(0) {}
+
+        int next() {
+            if (pos < count)
+                return out[pos++];
+            int v[4], k = 0, pad = 0;
+            while (k < 4) {
+                int c = xml.peek();
+                if (c < 0 || c == '<')
+                    break;
+                xml.get();
+                if (XmlStream::isSpace(c))
+                    continue;
+                if (c == '=') {
+                    v[k++] = 0;
+                    pad++;
+                    continue;
+                }
+                v[k] = value(c);
+                if (v[k] < 0 || pad) {
+                    error = true;
+                    return -1;
+                }
+                k++;
+            }
+            if (k < 4) {
+                error = error || k > 0;
+                return -1;
+            }
+            unsigned int bits = (v[0] << 18) | (v[1] << 12) | (v[2] << 6) | v[3];
+            out[0] = bits >> 16;
+            out[1] = (bits >> 8) & 0xFF;
+            out[2] = bits & 0xFF;
+            count = 3 - pad;
+            pos = 0;
+            return count > 0 ? out[pos++] : -1;
+        }
+    };
+
+    // Inflate (RFC 1951) com saída puxada byte a byte e janela de 32 KB;
+    // lê o cabeçalho e confere o rodapé do zlib (RFC 1950) ou do gzip (RFC 1952).
+    class InflateSource : public ByteSource {
+        struct Huffman {
+            short count[16];
+            short symbol[288];
+        };
+
+        enum { HEADER, STORED, CODES, DONE };
+
+        ByteSource &in;
+        bool gzip;
+        unsigned long bitbuf;
+        int bitcnt;
+        unsigned char window[32768];
+        unsigned long total;        // bytes já produzidos
+        int state;
+        bool last;
+        unsigned int stored;        // bytes restantes do bloco sem compressão
+        unsigned int copyLen, copyDist;
+        Huffman lencode, distcode;
+        unsigned long adler, crc;
+
+        static const unsigned long *crcTable() {
+            static unsigned long table[256];
+            static bool ready = false;
+            if (!ready) {
+                for (unsigned long n = 0; n < 256; n++) {
+                    unsigned long c = n;
+                    for (int k = 0; k < 8; k++)
+                        c = c & 1 ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+                    table[n] = c;
+                }
+                ready = true;
+            }
+            return table;
+        }
+
+        int byte() {
+            int b = in.next();
+            if (b < 0)
+                error = true;
+            return b;
+        }
+
+        int bits(int n) {
+            while (bitcnt < n) {
+                int b = byte();
+                if (b < 0)
+                    return -1;
+                bitbuf |= (unsigned long)b << bitcnt;
+                bitcnt += 8;
+            }
+            int v = (int)(bitbuf & ((1UL << n) - 1));
+            bitbuf >>= n;
+            bitcnt -= n;
+            return v;
+        }
+
+        static void build(Huffman &h, const short *length, int n) {
+            short offs[16];
+            memset(h.count, 0, sizeof(h.count));
+            for (int s = 0; s < n; s++)
+                h.count[length[s]]++;
+            h.count[0] = 0;
+            offs[1] = 0;
+            for (int len = 1; len < 15; len++)
+                offs[len + 1] = offs[len] + h.count[len];
+            for (int s = 0; s < n; s++)
+                if (length[s])
+                    h.symbol[offs[length[s]]++] = (short)s;
+        }
+
+        // Decodificação canônica bit a bit (como no puff.c do zlib)
+        int decode(const Huffman &h) {
+            int code = 0, first = 0, index = 0;
+            for (int len = 1; len < 16; len++) {
+                int b = bits(1);
+                if (b < 0)
+                    return -1;
+                code |= b;
+                int count = h.count[len];
+                if (code - count < first)
+                    return h.symbol[index + (code - first)];
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+            error = true;
+            return -1;
+        }
+
+        bool header() {
+            int bfinal = bits(1), type = bits(2);
+            if (bfinal < 0 || type < 0)
+                return false;
+            last = bfinal == 1;
+
+            if (type == 0) {
+                bitbuf = 0; // resto do byte atual é descartado
+                bitcnt = 0;
+                int a = byte(), b = byte(), c = byte(), d = byte();
+                if (d < 0 || (a | (b << 8)) != (~(c | (d << 8)) & 0xFFFF))
+                    return false;
+                stored = a | (b << 8);
+                state = STORED;
+                return true;
+            }
+
+            if (type == 1) {
+                short lengths[288];
+                for (int s = 0; s < 144; s++) lengths[s] = 8;
+                for (int s = 144; s < 256; s++) lengths[s] = 9;
+                for (int s = 256; s < 280; s++) lengths[s] = 7;
+                for (int s = 280; s < 288; s++) lengths[s] = 8;
+                build(lencode, lengths, 288);
+                for (int s = 0; s < 30; s++) lengths[s] = 5;
+                build(distcode, lengths, 30);
+                state = CODES;
+                return true;
+            }
+
+            if (type == 2) {
+                static const short order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+                int nlen = bits(5) + 257, ndist = bits(5) + 1, ncode = bits(4) + 4;
+                if (error || nlen > 286 || ndist > 30)
+                    return false;
+                short lengths[320];
+                memset(lengths, 0, sizeof(lengths));
+                for (int i = 0; i < ncode; i++)
+                    lengths[order[i]] = (short)bits(3);
+                // fluxo truncado: bits() deu -1, que não pode virar índice em build()
+                if (error)
+                    return false;
+                Huffman lencodes;
+                build(lencodes, lengths, 19);
+
+                int index = 0;
+                while (index < nlen + ndist) {
+                    int sym = decode(lencodes);
+                    if (sym < 0 || error)
+                        return false;
+                    if (sym < 16) {
+                        lengths[index++] = (short)sym;
+                        continue;
+                    }
+                    short len = 0;
+                    int rep;
+                    if (sym == 16) {
+                        if (index == 0)
+                            return false;
+                        len = lengths[index - 1];
+                        rep = 3 + bits(2);
+                    } else if (sym == 17) {
+                        rep = 3 + bits(3);
+                    } else {
+                        rep = 11 + bits(7);
+                    }
+                    if (error || index + rep > nlen + ndist)
+                        return false;
+                    while (rep--)
+                        lengths[index++] = len;
+                }
+                build(lencode, lengths, nlen);
+                build(distcode, lengths + nlen, ndist);
+                state = CODES;
+                return true;
+            }
+
+            return false;
+        }
+
+        int put(int b) {
+            window[total & 32767] = (unsigned char)b;
+            total++;
+            if (gzip) {
+                crc = crcTable()[(crc ^ b) & 0xFF] ^ (crc >> 8);
+            } else {
+                unsigned long s1 = adler & 0xFFFF, s2 = adler >> 16;
+                s1 = (s1 + b) % 65521;
+                s2 = (s2 + s1) % 65521;
+                adler = (s2 << 16) | s1;
+            }
+            return b;
+        }
+
+        bool readHeader() {
+            if (!gzip) {
+                int cmf = byte(), flg = byte();
+                return flg >= 0 && (cmf & 0x0F) == 8 && ((cmf << 8) | flg) % 31 == 0 && !(flg & 0x20);
+            }
+            int id1 = byte(), id2 = byte(), cm = byte(), flg = byte();
+            if (flg < 0 || id1 != 0x1F || id2 != 0x8B || cm != 8)
+                return false;
+            for (int i = 0; i < 6; i++) // mtime, xfl, os
+                byte();
+            if (flg & 4) { // FEXTRA
+                int a = byte(), b = byte();
+                for (int n = a | (b << 8); n > 0 && !error; n--)
+                    byte();
+            }
+            for (int f = 8; f <= 16; f <<= 1) // FNAME, FCOMMENT
+                if (flg & f)
+                    while (byte() > 0) {}
+            if (flg & 2) { // FHCRC
+                byte();
+                byte();
+            }
+            return !error;
+        }
+
+        unsigned long readLE32() {
+            unsigned long v = 0;
+            for (int i = 0; i < 4; i++)
+                v |= (unsigned long)(byte() & 0xFF) << (8 * i);
+            return v;
+        }
+
+        bool checkTrailer() {
+            bitbuf = 0;
+            bitcnt = 0;
+            if (gzip) {
+                unsigned long c = readLE32(), size = readLE32();
+                return !error && c == (crc ^ 0xFFFFFFFFUL) && size == (total & 0xFFFFFFFFUL);
+            }
+            unsigned long a = 0;
+            for (int i = 0; i < 4; i++)
+                a = (a << 8) | (byte() & 0xFF);
+            return !error && a == adler;
+        }
+
+    public:
+        InflateSource(ByteSource &in, bool gzip) : in(in), gzip(gzip) {
+            bitbuf = 0;
+            bitcnt = 0;
+            total = 0;
+            last = false;
+            stored = copyLen = copyDist = 0;
+            adler = 1;
+            crc = 0xFFFFFFFFUL;
+            state = HEADER;
+            if (!readHeader())
+                error = true;
+        }
+
+        int next() {
+            for (;;) {
+                if (error)
+                    return -1;
+                if (copyLen) {
+                    copyLen--;
+                    return put(window[(total - copyDist) & 32767]);
+                }
+                switch (state) {
+                case HEADER:
+                    if (!header())
+                        error = true;
+                    continue;
+                case STORED:
+                    if (stored == 0) {
+                        if (last) {
+                            state = DONE;
+                            if (!checkTrailer())
+                                error = true;
+                            return -1;
+                        }
+                        state = HEADER;
+                        continue;
+                    } else {
+                        int b = byte();
+                        if (b < 0)
+                            return -1;
+                        stored--;
+                        return put(b);
+                    }
+                case CODES: {
+                    static const short lbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+                    static const short lext[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                    static const unsigned short dbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                                             257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                                             8193, 12289, 16385, 24577};
+                    static const short dext[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                                   7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+                    int sym = decode(lencode);
+                    if (sym < 0)
+                        continue;
+                    if (sym < 256)
+                        return put(sym);
+                    if (sym == 256) {
+                        if (last) {
+                            state = DONE;
+                            if (!checkTrailer())
+                                error = true;
+                            return -1;
+                        }
+                        state = HEADER;
+                        continue;
+                    }
+                    sym -= 257;
+                    if (sym >= 29) {
+                        error = true;
+                        continue;
+                    }
+                    int len = lbase[sym] + bits(lext[sym]);
+                    int dsym = decode(distcode);
+                    if (dsym < 0 || dsym >= 30) {
+                        error = true;
+                        continue;
+                    }
+                    int dist = dbase[dsym] + bits(dext[dsym]);
+                    if (error || (unsigned long)dist > total) {
+                        error = true;
+                        continue;
+                    }
+                    copyLen = len;
+                    copyDist = dist;
+                    continue;
+                }
+                default:
+                    return -1;
+                }
+            }
+        }
+
+        bool finished() const {
+            return state == DONE && !error;
+        }
+    };
+
+    // ---------------------------------------------------------------- camadas
+    // Lê n gids em linhas de w tiles a partir de (x0, y0) e entrega ao listener
+    static bool readGids(XmlStream &xml, const std::string &encoding, const std::string &compression,
+                         const TmxLayerInfo &layer, int x0, int y0, int w, int h,
+                         TmxListener &listener, std::string &err) {
+        std::vector<uint32_t> row(w > 0 ? w : 1);
+
+        if (encoding == "csv") {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    int c = xml.peek();
+                    while (c == ',' || XmlStream::isSpace(c)) {
+                        xml.get();
+                        c = xml.peek();
+                    }
+                    if (c < '0' || c > '9') {
+                        err = "Camada \"" + layer.name + "\": CSV com menos tiles que o esperado";
+                        return false;
+                    }
+                    unsigned long v = 0;
+                    while ((c = xml.peek()) >= '0' && c <= '9') {
+                        v = v * 10 + (c - '0');
+                        xml.get();
+                    }
+                    row[x] = (uint32_t)v & TMX_GID_MASK;
+                }
+                if (!listener.row(layer, x0, y0 + y, w, row.data(), err))
+                    return false;
+            }
+            return true;
+        }
+
+        if (encoding != "base64") {
+            err = "Codificação \"" + encoding + "\" não suportada";
+            return false;
+        }
+
+        Base64Source base64(xml);
+        InflateSource *inflate = NULL;
+        if (compression == "zlib" || compression == "gzip") {
+            inflate = new InflateSource(base64, compression == "gzip");
+        } else if (!compression.empty()) {
+            err = "Compressão \"" + compression + "\" não suportada";
+            return false;
+        }
+        ByteSource &src = inflate ? (ByteSource &)*inflate : (ByteSource &)base64;
+
+        bool ok = true;
+        for (int y = 0; y < h && ok; y++) {
+            for (int x = 0; x < w && ok; x++) {
+                int b0 = src.next(), b1 = src.next(), b2 = src.next(), b3 = src.next();
+                if (b3 < 0) {
+                    err = "Camada \"" + layer.name + "\": dados base64 corrompidos ou curtos";
+                    ok = false;
+                    break;
+                }
+                row[x] = ((uint32_t)b0 | ((uint32_t)b1 << 8) | ((uint32_t)b2 << 16) | ((uint32_t)b3 << 24)) & TMX_GID_MASK;
+            }
+            if (ok)
+                ok = listener.row(layer, x0, y0 + y, w, row.data(), err);
+        }
+        if (ok && inflate && (inflate->next() >= 0 || !inflate->finished())) {
+            err = "Camada \"" + layer.name + "\": dados comprimidos corrompidos";
+            ok = false;
+        }
+        delete inflate;
+        return ok;
+    }
+
+    // <data> de uma camada: texto direto (mapa finito), <chunk>s ou <tile>s
+    static bool readData(XmlStream &xml, const Tag &data, const TmxLayerInfo &layer,
+                         TmxListener &listener, std::string &err) {
+        std::string encoding = data.attr("encoding"), compression = data.attr("compression");
+        if (data.selfClosing)
+            return true;
+
+        if (!encoding.empty() && xml.peekNonSpace() != '<')
+            return readGids(xml, encoding, compression, layer, 0, 0, layer.width, layer.height, listener, err);
+
+        Tag tag;
+        int index = 0; // para <tile gid> sem codificação
+        while (xml.nextTag(tag)) {
+            if (tag.name == "/data")
+                return true;
+            if (tag.name == "chunk" && !tag.selfClosing) {
+                if (encoding.empty()) {
+                    err = "Chunks sem codificação não são suportados";
+                    return false;
+                }
+                if (!readGids(xml, encoding, compression, layer, tag.intAttr("x"), tag.intAttr("y"),
+                              tag.intAttr("width"), tag.intAttr("height"), listener, err))
+                    return false;
+            } else if (tag.name == "tile" && layer.width > 0) {
+                uint32_t gid = (uint32_t)strtoul(tag.attr("gid", "0").c_str(), NULL, 10) & TMX_GID_MASK;
+                if (!listener.row(layer, index % layer.width, index / layer.width, 1, &gid, err))
+                    return false;
+                index++;
+            }
+        }
+        err = "Fim de arquivo dentro de <data>";
+        return false;
+    }
+
+    // ---------------------------------------------------------------- TileMap
+    // Monta os TileMaps. Mapas finitos são escritos direto no TileMap; em mapas
+    // infinitos só as linhas dos chunks (1 byte por tile) ficam guardadas até o
+    // fim da camada, quando o tamanho final é conhecido.
+    struct TileMapBuilder : public TmxListener {
+        struct Run {
+            int x, y;
+            std::vector<unsigned char> ids;
+        };
+
+        std::vector<TmxTileLayer> &layers;
+        bool flipY;
+        unsigned char emptyTile;
+        bool allowEmpty;            // false: gid 0 ou tile faltando é erro
+        unsigned int firstgid;
+        bool infinite;
+        std::vector<Run> runs;
+        size_t placed;              // tiles recebidos na camada atual
+
+        TileMapBuilder(std::vector<TmxTileLayer> &layers, bool flipY, unsigned char emptyTile, bool allowEmpty)
+            : layers(layers), flipY(flipY), emptyTile(emptyTile), allowEmpty(allowEmpty), firstgid(1),
+              infinite(false), placed(0) {}
+
+        // Sem allowEmpty, um gid 0 não pode virar emptyTile: seria igual a um tile de verdade
+        bool checkEmpty(const TmxLayerInfo &layer, int x, int y, int n, const uint32_t *gids, std::string &err) {
+            if (this->allowEmpty)
+                return true;
+            for (int i = 0; i < n; i++)
+                if (gids[i] == 0) {
+                    err = "Camada \"" + layer.name + "\": tile vazio em (" + std::to_string(x + i) + ", " +
+                          std::to_string(y) + ")";
+                    return false;
+                }
+            return true;
+        }
+
+        bool toId(uint32_t gid, unsigned char &id, std::string &err) {
+            if (gid == 0) {
+                id = this->emptyTile;
+                return true;
+            }
+            if (gid < this->firstgid || gid - this->firstgid > 255) {
+                err = "gid " + std::to_string(gid) + " não cabe em um TileMap (ids de 0 a 255)";
+                return false;
+            }
+            id = (unsigned char)(gid - this->firstgid);
+            return true;
+        }
+
+        bool map(const TmxMapInfo &info, std::string &err);
+        bool beginLayer(const TmxLayerInfo &layer, std::string &err);
+        bool row(const TmxLayerInfo &layer, int x, int y, int n, const uint32_t *gids, std::string &err);
+        bool endLayer(const TmxLayerInfo &layer, std::string &err);
+    };
+
+public:
+    // Lê o .tmx chamando o listener; info recebe o cabeçalho do mapa.
+    static bool load(const std::string &path, TmxListener &listener, TmxMapInfo &info, std::string &err) {
+        XmlStream xml;
+        if (!xml.open(path)) {
+            err = "Não foi possível abrir " + path;
+            return false;
+        }
+
+        info = TmxMapInfo();
+        info.width = info.height = info.tileW = info.tileH = 0;
+        info.infinite = false;
+
+        Tag tag;
+        TmxLayerInfo layer;
+        layer.index = -1;
+        bool inLayer = false, sawMap = false;
+        int tilesetDepth = 0; // <tile>s dentro de <tileset> não são dados de camada
+
+        while (xml.nextTag(tag)) {
+            if (tag.name == "map") {
+                info.orientation = tag.attr("orientation", "orthogonal");
+                info.width = tag.intAttr("width");
+                info.height = tag.intAttr("height");
+                info.tileW = tag.intAttr("tilewidth");
+                info.tileH = tag.intAttr("tileheight");
+                info.infinite = tag.intAttr("infinite") == 1;
+                sawMap = true;
+            } else if (tag.name == "tileset") {
+                std::string name = tag.attr("source");
+                if (name.empty())
+                    name = tag.attr("name");
+                info.tilesets.push_back(std::make_pair((unsigned int)tag.intAttr("firstgid", 1), name));
+                if (!tag.selfClosing)
+                    tilesetDepth++;
+            } else if (tag.name == "/tileset") {
+                tilesetDepth--;
+            } else if (tilesetDepth > 0) {
+                continue;
+            } else if (tag.name == "layer") {
+                if (layer.index < 0 && !listener.map(info, err)) // tilesets já foram lidos
+                    return false;
+                layer.index++;
+                layer.name = tag.attr("name");
+                layer.width = tag.intAttr("width", info.width);
+                layer.height = tag.intAttr("height", info.height);
+                if (!listener.beginLayer(layer, err))
+                    return false;
+                inLayer = !tag.selfClosing;
+                if (!inLayer && !listener.endLayer(layer, err))
+                    return false;
+            } else if (tag.name == "data" && inLayer) {
+                if (!readData(xml, tag, layer, listener, err))
+                    return false;
+            } else if (tag.name == "/layer" && inLayer) {
+                inLayer = false;
+                if (!listener.endLayer(layer, err))
+                    return false;
+            }
+        }
+
+        if (!sawMap) {
+            err = path + " não é um mapa .tmx";
+            return false;
+        }
+        if (inLayer) {
+            err = "Fim de arquivo dentro de <layer>";
+            return false;
+        }
+        if (layer.index < 0 && !listener.map(info, err))
+            return false;
+        return true;
+    }
+
+    // Um TileMap por camada de tiles (z = índice da camada). Ids são gid - firstgid
+    // do primeiro tileset; tiles vazios viram emptyTile. Com flipY, a linha 0 do
+    // TileMap é a última do arquivo (y para cima, como no readMap do exemplo_07).
+    // Com allowEmpty = false, tiles vazios ou faltando (inclusive fora dos
+    // chunks de um mapa infinito) são erro em vez de emptyTile.
+    static bool loadTileMaps(const std::string &path, std::vector<TmxTileLayer> &layers, TmxMapInfo &info,
+                             std::string &err, bool flipY = false, unsigned char emptyTile = 0,
+                             bool allowEmpty = true) {
+        layers.clear();
+        TileMapBuilder builder(layers, flipY, emptyTile, allowEmpty);
+        if (load(path, builder, info, err))
+            return true;
+        for (size_t i = 0; i < layers.size(); i++)
+            delete layers[i].tiles;
+        layers.clear();
+        return false;
+    }
+};
+
+inline bool TmxImporter::TileMapBuilder::map(const TmxMapInfo &info, std::string & /*err*/) {
+    this->infinite = info.infinite;
+    if (!info.tilesets.empty())
+        this->firstgid = info.tilesets[0].first;
+    return true;
+}
+
+inline bool TmxImporter::TileMapBuilder::beginLayer(const TmxLayerInfo &layer, std::string &err) {
+    TmxTileLayer l;
+    l.name = layer.name;
+    l.originX = l.originY = 0;
+    l.tiles = NULL;
+    if (!this->infinite) {
+        if (layer.width <= 0 || layer.height <= 0) {
+            err = "Camada \"" + layer.name + "\" sem tamanho";
+            return false;
+        }
+        l.tiles = new TileMap(layer.width, layer.height, this->emptyTile);
+        l.tiles->setZ((float)layer.index);
+    }
+    this->layers.push_back(l);
+    this->runs.clear();
+    this->placed = 0;
+    return true;
+}
+
+inline bool TmxImporter::TileMapBuilder::row(const TmxLayerInfo &layer, int x, int y, int n, const uint32_t *gids, std::string &err) {
+    if (!checkEmpty(layer, x, y, n, gids, err))
+        return false;
+    this->placed += n;
+    if (this->infinite) {
+        Run run;
+        run.x = x;
+        run.y = y;
+        run.ids.resize(n);
+        for (int i = 0; i < n; i++)
+            if (!toId(gids[i], run.ids[i], err))
+                return false;
+        this->runs.push_back(run);
+        return true;
+    }
+
+    TileMap *tm = this->layers.back().tiles;
+    if (y < 0 || y >= tm->getHeight() || x < 0 || x + n > tm->getWidth()) {
+        err = "Camada \"" + layer.name + "\": tiles fora do tamanho declarado";
+        return false;
+    }
+    int r = this->flipY ? tm->getHeight() - 1 - y : y;
+    for (int i = 0; i < n; i++) {
+        unsigned char id;
+        if (!toId(gids[i], id, err))
+            return false;
+        tm->setTile(x + i, r, id);
+    }
+    return true;
+}
+
+inline bool TmxImporter::TileMapBuilder::endLayer(const TmxLayerInfo &layer, std::string &err) {
+    if (!this->infinite) {
+        if (!this->allowEmpty && this->placed != (size_t)layer.width * layer.height) {
+            err = "Camada \"" + layer.name + "\": " + std::to_string(this->placed) + " tiles, esperados " +
+                  std::to_string((size_t)layer.width * layer.height);
+            return false;
+        }
+        return true;
+    }
+
+    TmxTileLayer &l = this->layers.back();
+    if (this->runs.empty() && !this->allowEmpty) {
+        err = "Camada \"" + layer.name + "\" sem tiles";
+        return false;
+    }
+    if (this->runs.empty()) {
+        l.tiles = new TileMap(1, 1, this->emptyTile);
+        l.tiles->setZ((float)layer.index);
+        return true;
+    }
+
+    int minX = this->runs[0].x, minY = this->runs[0].y;
+    int maxX = minX, maxY = minY; // exclusivos
+    for (size_t i = 0; i < this->runs.size(); i++) {
+        const Run &run = this->runs[i];
+        if (run.x < minX) minX = run.x;
+        if (run.y < minY) minY = run.y;
+        if (run.x + (int)run.ids.size() > maxX) maxX = run.x + (int)run.ids.size();
+        if (run.y + 1 > maxY) maxY = run.y + 1;
+    }
+
+    int w = maxX - minX, h = maxY - minY;
+    // chunks não se sobrepõem: menos tiles que o retângulo quer dizer buracos
+    if (!this->allowEmpty && this->placed != (size_t)w * h) {
+        err = "Camada \"" + layer.name + "\": os chunks não cobrem o retângulo " + std::to_string(w) + "x" +
+              std::to_string(h) + " (tiles vazios)";
+        return false;
+    }
+    l.tiles = new TileMap(w, h, this->emptyTile);
+    l.tiles->setZ((float)layer.index);
+    l.originX = minX;
+    l.originY = this->flipY ? maxY - 1 : minY;
+    for (size_t i = 0; i < this->runs.size(); i++) {
+        const Run &run = this->runs[i];
+        int r = run.y - minY;
+        if (this->flipY)
+            r = h - 1 - r;
+        memcpy(l.tiles->getMap() + (size_t)r * w + (run.x - minX), run.ids.data(), run.ids.size());
+    }
+    std::vector<Run>().swap(this->runs);
+    return true;
+}
+
+#endif /* TmxImporter_h */
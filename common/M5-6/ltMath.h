@@ -61,21 +61,21 @@ float triangleArea2D(float *triangle){
     return fabs(((triangle[2] - triangle[0])*(triangle[5] - triangle[1]) - (triangle[4] - triangle[0]) * (triangle[3] - triangle[1]))/2);
 }
 
-// tests: triangle area X point--sub-triangles areas
-bool triangleCollidePoint2D(float *triangle, float *point){
-	float a = triangleArea2D(triangle);
-
-    float subtri1[] = {triangle[0], triangle[1], triangle[2], triangle[3], point[0], point[1]};
-    float subtri2[] = {triangle[0], triangle[1], point[0], point[1], triangle[4], triangle[5]};
-    float subtri3[] = {point[0], point[1], triangle[2], triangle[3], triangle[4], triangle[5]};
-    
-	float a1 = triangleArea2D(subtri1);
-	float a2 = triangleArea2D(subtri2);
-	float a3 = triangleArea2D(subtri3);
+// lado do ponto p em relação à aresta a->b: > 0 à esquerda, < 0 à direita, 0 em cima
+float edgeSide2D(float ax, float ay, float bx, float by, float px, float py){
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
 
-    // cout << "\tDEBUG => a: " << a << " a1: " << a1 << " + a2: " << a2 << " + a3: " << a3 << " = " << (a1+a2+a3) << endl;
-	
-	return a == (a1+a2+a3);
+// tests: point on the same side of the three edges (or on an edge). Comparar a
+// área do triângulo com a soma das sub-áreas usando == falhava por arredondamento.
+// Para selecionar tiles, prefira TilemapView::getPicker (TilemapView.h).
+bool triangleCollidePoint2D(float *triangle, float *point){
+    float d1 = edgeSide2D(triangle[0], triangle[1], triangle[2], triangle[3], point[0], point[1]);
+    float d2 = edgeSide2D(triangle[2], triangle[3], triangle[4], triangle[5], point[0], point[1]);
+    float d3 = edgeSide2D(triangle[4], triangle[5], triangle[0], triangle[1], point[0], point[1]);
+    bool neg = d1 < 0 || d2 < 0 || d3 < 0;
+    bool pos = d1 > 0 || d2 > 0 || d3 > 0;
+    return !(neg && pos);
 }
 
 bool collideByDotProduct(float *triangle, float *point){
@@ -17,6 +17,26 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+/* SSE is part of every x86-64 target (and of 32-bit x86 with /arch:SSE or
+-msse); AVX only when the compiler is told so (-mavx, /arch:AVX). define
+MATHS_NO_SIMD to build the plain C++ versions only. */
+#if !defined(MATHS_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATHS_SSE
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#define MATHS_AVX
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef MATHS_SSE
+// shuffle of one register: lanes (x, y, z, w) of v
+#define MATHS_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps (v, v, _MM_SHUFFLE (w, z, y, x))
+// lanes (x, y) of a, then (z, w) of b
+#define MATHS_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps (a, b, _MM_SHUFFLE (w, z, y, x))
+#endif
+
 /*--------------------------------CONSTRUCTORS--------------------------------*/
 vec2::vec2 () {}
 
@@ -309,39 +329,39 @@ mat4 identity_mat4 () {
  3  7 11 15
 */
 
-vec4 mat4::operator* (const vec4& rhs) {
+vec4 mul_scalar (const mat4& mm, const vec4& rhs) {
 	// 0x + 4y + 8z + 12w
 	float x =
-		m[0] * rhs.v[0] +
-		m[4] * rhs.v[1] +
-		m[8] * rhs.v[2] +
-		m[12] * rhs.v[3];
+		mm.m[0] * rhs.v[0] +
+		mm.m[4] * rhs.v[1] +
+		mm.m[8] * rhs.v[2] +
+		mm.m[12] * rhs.v[3];
 	// 1x + 5y + 9z + 13w
-	float y = m[1] * rhs.v[0] +
-		m[5] * rhs.v[1] +
-		m[9] * rhs.v[2] +
-		m[13] * rhs.v[3];
+	float y = mm.m[1] * rhs.v[0] +
+		mm.m[5] * rhs.v[1] +
+		mm.m[9] * rhs.v[2] +
+		mm.m[13] * rhs.v[3];
 	// 2x + 6y + 10z + 14w
-	float z = m[2] * rhs.v[0] +
-		m[6] * rhs.v[1] +
-		m[10] * rhs.v[2] +
-		m[14] * rhs.v[3];
+	float z = mm.m[2] * rhs.v[0] +
+		mm.m[6] * rhs.v[1] +
+		mm.m[10] * rhs.v[2] +
+		mm.m[14] * rhs.v[3];
 	// 3x + 7y + 11z + 15w
-	float w = m[3] * rhs.v[0] +
-		m[7] * rhs.v[1] +
-		m[11] * rhs.v[2] +
-		m[15] * rhs.v[3];
+	float w = mm.m[3] * rhs.v[0] +
+		mm.m[7] * rhs.v[1] +
+		mm.m[11] * rhs.v[2] +
+		mm.m[15] * rhs.v[3];
 	return vec4 (x, y, z, w);
 }
 
-mat4 mat4::operator* (const mat4& rhs) {
+mat4 mul_scalar (const mat4& mm, const mat4& rhs) {
 	mat4 r = zero_mat4 ();
 	int r_index = 0;
 	for (int col = 0; col < 4; col++) {
 		for (int row = 0; row < 4; row++) {
 			float sum = 0.0f;
 			for (int i = 0; i < 4; i++) {
-				sum += rhs.m[i + col * 4] * m[row + i * 4];
+				sum += rhs.m[i + col * 4] * mm.m[row + i * 4];
 			}
 			r.m[r_index] = sum;
 			r_index++;
@@ -350,6 +370,43 @@ mat4 mat4::operator* (const mat4& rhs) {
 	return r;
 }
 
+vec4 mat4::operator* (const vec4& rhs) {
+#ifdef MATHS_SSE
+	// x * column 0 + y * column 1 + z * column 2 + w * column 3
+	__m128 r = _mm_mul_ps (_mm_loadu_ps (&m[0]), _mm_set1_ps (rhs.v[0]));
+	r = _mm_add_ps (r, _mm_mul_ps (_mm_loadu_ps (&m[4]), _mm_set1_ps (rhs.v[1])));
+	r = _mm_add_ps (r, _mm_mul_ps (_mm_loadu_ps (&m[8]), _mm_set1_ps (rhs.v[2])));
+	r = _mm_add_ps (r, _mm_mul_ps (_mm_loadu_ps (&m[12]), _mm_set1_ps (rhs.v[3])));
+	vec4 result;
+	_mm_storeu_ps (result.v, r);
+	return result;
+#else
+	return mul_scalar (*this, rhs);
+#endif
+}
+
+mat4 mat4::operator* (const mat4& rhs) {
+#ifdef MATHS_SSE
+	// each column of the result is this matrix times a column of rhs
+	__m128 c0 = _mm_loadu_ps (&m[0]);
+	__m128 c1 = _mm_loadu_ps (&m[4]);
+	__m128 c2 = _mm_loadu_ps (&m[8]);
+	__m128 c3 = _mm_loadu_ps (&m[12]);
+	mat4 r;
+	for (int col = 0; col < 4; col++) {
+		const float* b = &rhs.m[col * 4];
+		__m128 sum = _mm_mul_ps (c0, _mm_set1_ps (b[0]));
+		sum = _mm_add_ps (sum, _mm_mul_ps (c1, _mm_set1_ps (b[1])));
+		sum = _mm_add_ps (sum, _mm_mul_ps (c2, _mm_set1_ps (b[2])));
+		sum = _mm_add_ps (sum, _mm_mul_ps (c3, _mm_set1_ps (b[3])));
+		_mm_storeu_ps (&r.m[col * 4], sum);
+	}
+	return r;
+#else
+	return mul_scalar (*this, rhs);
+#endif
+}
+
 mat4& mat4::operator= (const mat4& rhs) {
 	for (int i = 0; i < 16; i++) {
 		m[i] = rhs.m[i];
@@ -389,7 +446,7 @@ float determinant (const mat4& mm) {
 
 /* returns a 16-element array that is the inverse of a 16-element array (4x4
 matrix). see http://www.euclideanspace.com/maths/algebra/matrix/functions/inverse/fourD/index.htm */
-mat4 inverse (const mat4& mm) {
+mat4 inverse_scalar (const mat4& mm) {
 	float det = determinant (mm);
 	/* there is no inverse if determinant is zero (not likely unless scale is
 	broken) */
@@ -484,7 +541,7 @@ mat4 inverse (const mat4& mm) {
 }
 
 // returns a 16-element array flipped on the main diagonal
-mat4 transpose (const mat4& mm) {
+mat4 transpose_scalar (const mat4& mm) {
 	return mat4 (
 		mm.m[0], mm.m[4], mm.m[8], mm.m[12],
 		mm.m[1], mm.m[5], mm.m[9], mm.m[13],
@@ -493,6 +550,189 @@ mat4 transpose (const mat4& mm) {
 	);
 }
 
+#ifdef MATHS_SSE
+// 2x2 blocks are kept in one register as (a b c d) = | a b |
+//                                                    | c d |
+// A * B
+static inline __m128 mat2_mul (__m128 a, __m128 b) {
+	return _mm_add_ps (
+		_mm_mul_ps (a, MATHS_SWIZZLE (b, 0, 3, 0, 3)),
+		_mm_mul_ps (MATHS_SWIZZLE (a, 1, 0, 3, 2), MATHS_SWIZZLE (b, 2, 1, 2, 1)));
+}
+
+// adjugate(A) * B
+static inline __m128 mat2_adj_mul (__m128 a, __m128 b) {
+	return _mm_sub_ps (
+		_mm_mul_ps (MATHS_SWIZZLE (a, 3, 3, 0, 0), b),
+		_mm_mul_ps (MATHS_SWIZZLE (a, 1, 1, 2, 2), MATHS_SWIZZLE (b, 2, 3, 0, 1)));
+}
+
+// A * adjugate(B)
+static inline __m128 mat2_mul_adj (__m128 a, __m128 b) {
+	return _mm_sub_ps (
+		_mm_mul_ps (a, MATHS_SWIZZLE (b, 3, 0, 3, 0)),
+		_mm_mul_ps (MATHS_SWIZZLE (a, 1, 0, 3, 2), MATHS_SWIZZLE (b, 2, 1, 2, 1)));
+}
+#endif
+
+/* same result as inverse_scalar (to rounding), by blocks: with the matrix as
+| A B | in 2x2 blocks, the inverse comes from the 2x2 adjugates and
+| C D | determinants, about 60 multiplies instead of 200. the inverse of the
+transpose is the transpose of the inverse, so taking the columns as rows
+works the same. */
+mat4 inverse (const mat4& mm) {
+#ifdef MATHS_SSE
+	__m128 c0 = _mm_loadu_ps (&mm.m[0]);
+	__m128 c1 = _mm_loadu_ps (&mm.m[4]);
+	__m128 c2 = _mm_loadu_ps (&mm.m[8]);
+	__m128 c3 = _mm_loadu_ps (&mm.m[12]);
+	__m128 A = _mm_movelh_ps (c0, c1);
+	__m128 B = _mm_movehl_ps (c1, c0);
+	__m128 C = _mm_movelh_ps (c2, c3);
+	__m128 D = _mm_movehl_ps (c3, c2);
+
+	// (|A| |B| |C| |D|)
+	__m128 det_sub = _mm_sub_ps (
+		_mm_mul_ps (MATHS_SHUFFLE (c0, c2, 0, 2, 0, 2), MATHS_SHUFFLE (c1, c3, 1, 3, 1, 3)),
+		_mm_mul_ps (MATHS_SHUFFLE (c0, c2, 1, 3, 1, 3), MATHS_SHUFFLE (c1, c3, 0, 2, 0, 2)));
+	__m128 det_a = MATHS_SWIZZLE (det_sub, 0, 0, 0, 0);
+	__m128 det_b = MATHS_SWIZZLE (det_sub, 1, 1, 1, 1);
+	__m128 det_c = MATHS_SWIZZLE (det_sub, 2, 2, 2, 2);
+	__m128 det_d = MATHS_SWIZZLE (det_sub, 3, 3, 3, 3);
+
+	__m128 d_c = mat2_adj_mul (D, C);
+	__m128 a_b = mat2_adj_mul (A, B);
+	// adjugates of the blocks of the inverse, times |M|
+	__m128 x = _mm_sub_ps (_mm_mul_ps (det_d, A), mat2_mul (B, d_c));
+	__m128 w = _mm_sub_ps (_mm_mul_ps (det_a, D), mat2_mul (C, a_b));
+	__m128 y = _mm_sub_ps (_mm_mul_ps (det_b, C), mat2_mul_adj (D, a_b));
+	__m128 z = _mm_sub_ps (_mm_mul_ps (det_c, B), mat2_mul_adj (A, d_c));
+
+	// |M| = |A||D| + |B||C| - trace(adj(A) B adj(D) C)
+	__m128 tr = _mm_mul_ps (a_b, MATHS_SWIZZLE (d_c, 0, 2, 1, 3));
+	tr = _mm_add_ps (tr, MATHS_SWIZZLE (tr, 2, 3, 0, 1));
+	tr = _mm_add_ps (tr, MATHS_SWIZZLE (tr, 1, 0, 3, 2));
+	__m128 det = _mm_sub_ps (_mm_add_ps (_mm_mul_ps (det_a, det_d), _mm_mul_ps (det_b, det_c)), tr);
+	if (0.0f == _mm_cvtss_f32 (det)) {
+		fprintf (stderr, "WARNING. matrix has no determinant. can not invert\n");
+		return mm;
+	}
+	__m128 inv_det = _mm_div_ps (_mm_setr_ps (1.0f, -1.0f, -1.0f, 1.0f), det);
+	x = _mm_mul_ps (x, inv_det);
+	y = _mm_mul_ps (y, inv_det);
+	z = _mm_mul_ps (z, inv_det);
+	w = _mm_mul_ps (w, inv_det);
+
+	// adjugate of each block and back to columns in one shuffle
+	mat4 r;
+	_mm_storeu_ps (&r.m[0], MATHS_SHUFFLE (x, y, 3, 1, 3, 1));
+	_mm_storeu_ps (&r.m[4], MATHS_SHUFFLE (x, y, 2, 0, 2, 0));
+	_mm_storeu_ps (&r.m[8], MATHS_SHUFFLE (z, w, 3, 1, 3, 1));
+	_mm_storeu_ps (&r.m[12], MATHS_SHUFFLE (z, w, 2, 0, 2, 0));
+	return r;
+#else
+	return inverse_scalar (mm);
+#endif
+}
+
+mat4 transpose (const mat4& mm) {
+#ifdef MATHS_SSE
+	__m128 c0 = _mm_loadu_ps (&mm.m[0]);
+	__m128 c1 = _mm_loadu_ps (&mm.m[4]);
+	__m128 c2 = _mm_loadu_ps (&mm.m[8]);
+	__m128 c3 = _mm_loadu_ps (&mm.m[12]);
+	_MM_TRANSPOSE4_PS (c0, c1, c2, c3);
+	mat4 r;
+	_mm_storeu_ps (&r.m[0], c0);
+	_mm_storeu_ps (&r.m[4], c1);
+	_mm_storeu_ps (&r.m[8], c2);
+	_mm_storeu_ps (&r.m[12], c3);
+	return r;
+#else
+	return transpose_scalar (mm);
+#endif
+}
+
+const char* maths_simd () {
+#if defined(MATHS_AVX)
+	return "AVX";
+#elif defined(MATHS_SSE)
+	return "SSE";
+#else
+	return "none";
+#endif
+}
+
+/*------------------------BATCH (STRUCTURE OF ARRAYS)-------------------------*/
+void transform_points_soa_scalar (const mat4& m, const float* x, const float* y,
+	const float* z, float* out_x, float* out_y, float* out_z, float* out_w, int n) {
+	for (int i = 0; i < n; i++) {
+		float px = x[i], py = y[i], pz = z ? z[i] : 0.0f;
+		float rx = m.m[0] * px + m.m[4] * py + m.m[8] * pz + m.m[12];
+		float ry = m.m[1] * px + m.m[5] * py + m.m[9] * pz + m.m[13];
+		float rz = m.m[2] * px + m.m[6] * py + m.m[10] * pz + m.m[14];
+		float rw = m.m[3] * px + m.m[7] * py + m.m[11] * pz + m.m[15];
+		out_x[i] = rx;
+		out_y[i] = ry;
+		if (out_z) {
+			out_z[i] = rz;
+		}
+		if (out_w) {
+			out_w[i] = rw;
+		}
+	}
+}
+
+/* one output row of the matrix per register (all lanes the same coefficient),
+4 or 8 points per iteration straight from the arrays: no shuffles, and the
+loop only waits on memory. the rest (n not a multiple) goes to the scalar
+version. */
+void transform_points_soa (const mat4& m, const float* x, const float* y,
+	const float* z, float* out_x, float* out_y, float* out_z, float* out_w, int n) {
+	int i = 0;
+#if defined(MATHS_AVX)
+	__m256 k[16];
+	for (int j = 0; j < 16; j++) {
+		k[j] = _mm256_set1_ps (m.m[j]);
+	}
+	for (; i + 8 <= n; i += 8) {
+		__m256 px = _mm256_loadu_ps (x + i);
+		__m256 py = _mm256_loadu_ps (y + i);
+		__m256 pz = z ? _mm256_loadu_ps (z + i) : _mm256_setzero_ps ();
+		float* out[4] = { out_x, out_y, out_z, out_w };
+		for (int row = 0; row < 4; row++) {
+			if (!out[row]) {
+				continue;
+			}
+			__m256 r = _mm256_add_ps (_mm256_mul_ps (k[row], px), _mm256_mul_ps (k[row + 4], py));
+			r = _mm256_add_ps (r, _mm256_mul_ps (k[row + 8], pz));
+			_mm256_storeu_ps (out[row] + i, _mm256_add_ps (r, k[row + 12]));
+		}
+	}
+#elif defined(MATHS_SSE)
+	__m128 k[16];
+	for (int j = 0; j < 16; j++) {
+		k[j] = _mm_set1_ps (m.m[j]);
+	}
+	for (; i + 4 <= n; i += 4) {
+		__m128 px = _mm_loadu_ps (x + i);
+		__m128 py = _mm_loadu_ps (y + i);
+		__m128 pz = z ? _mm_loadu_ps (z + i) : _mm_setzero_ps ();
+		float* out[4] = { out_x, out_y, out_z, out_w };
+		for (int row = 0; row < 4; row++) {
+			if (!out[row]) {
+				continue;
+			}
+			__m128 r = _mm_add_ps (_mm_mul_ps (k[row], px), _mm_mul_ps (k[row + 4], py));
+			r = _mm_add_ps (r, _mm_mul_ps (k[row + 8], pz));
+			_mm_storeu_ps (out[row] + i, _mm_add_ps (r, k[row + 12]));
+		}
+	}
+#endif
+	transform_points_soa_scalar (m, x + i, y + i, z ? z + i : NULL, out_x + i, out_y + i,
+		out_z ? out_z + i : NULL, out_w ? out_w + i : NULL, n - i);
+}
+
 /*--------------------------AFFINE MATRIX FUNCTIONS---------------------------*/
 // translate a 4d matrix with xyz array
 mat4 translate (const mat4& m, const vec3& v) {
@@ -736,3 +976,19 @@ versor slerp (versor& q, versor& r, float t) {
 	}
 	return result;
 }
+
+versor slerp (const versor& q, const versor& r, float t) {
+	versor a = q, b = r;
+	return slerp (a, b, t);
+}
+
+versor nlerp (const versor& q, const versor& r, float t) {
+	float sign = dot (q, r) < 0.0f ? -1.0f : 1.0f;
+	versor result;
+	float sum = 0.0f;
+	for (int i = 0; i < 4; i++) {
+		result.q[i] = (1.0f - t) * q.q[i] + t * sign * r.q[i];
+		sum += result.q[i] * result.q[i];
+	}
+	return result / sqrt (sum);
+}
@@ -134,6 +134,23 @@ mat4 identity_mat4 ();
 float determinant (const mat4& mm);
 mat4 inverse (const mat4& mm);
 mat4 transpose (const mat4& mm);
+/* the mat4 operators, inverse and transpose use SSE when the target has it
+(every x86-64 build); these are the plain C++ versions they replace, for
+other targets and for comparison */
+vec4 mul_scalar (const mat4& mm, const vec4& rhs);
+mat4 mul_scalar (const mat4& mm, const mat4& rhs);
+mat4 inverse_scalar (const mat4& mm);
+mat4 transpose_scalar (const mat4& mm);
+// "AVX", "SSE" or "none": what this build of the functions above uses
+const char* maths_simd ();
+// batch functions: positions stored as separate arrays (structure of arrays)
+/* m * (x[i], y[i], z[i], 1) for i in [0, n), into out_x[i], out_y[i],
+out_z[i], out_w[i]. z == NULL means z = 0 (2D sprites and tiles); out_z and
+out_w may be NULL when not wanted. output arrays may be the input ones. */
+void transform_points_soa (const mat4& m, const float* x, const float* y,
+	const float* z, float* out_x, float* out_y, float* out_z, float* out_w, int n);
+void transform_points_soa_scalar (const mat4& m, const float* x, const float* y,
+	const float* z, float* out_x, float* out_y, float* out_z, float* out_w, int n);
 // affine functions
 mat4 translate (const mat4& m, const vec3& v);
 mat4 rotate_x_deg (const mat4& m, float deg);
@@ -153,4 +170,8 @@ versor slerp (const versor& q, const versor& r);
 versor normalise (versor& q);
 void print (const versor& q);
 versor slerp (versor& q, versor& r, float t);
+// same, without touching q (the one above may negate it)
+versor slerp (const versor& q, const versor& r, float t);
+// normalised lerp (short way around): cheaper than slerp, same path
+versor nlerp (const versor& q, const versor& r, float t);
 #endif
@@ -0,0 +1,148 @@
+/******************************************************************************\
+| Wrapper de programa de shader com tabela de uniforms.                        |
+| Depois do link, todas as uniforms ativas são lidas uma única vez             |
+| (glGetActiveUniform) para uma tabela nome -> slot. Os setters usam essa      |
+| tabela em vez de glGetUniformLocation e guardam o último valor enviado de    |
+| cada uniform, pulando o glUniform* quando o valor não mudou.                 |
+| Os setters valem para o programa em uso (use()), como glUniform*.            |
+| fromFiles precisa de gl_utils.cpp no executável; o resto é só cabeçalho.     |
+\******************************************************************************/
+#ifndef _SHADER_PROGRAM_H_
+#define _SHADER_PROGRAM_H_
+
+#include "gl_utils.h"
+
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ShaderProgram {
+    struct Uniform {
+        GLint location;
+        GLenum type;
+        float value[16]; // último valor enviado (ints guardados bit a bit)
+        bool valid;      // false até o primeiro envio
+    };
+
+    GLuint id;
+    std::vector<Uniform> uniforms;
+    std::unordered_map<std::string, int> slots;
+
+    // Envia só se mudou; n floats de `value` identificam o valor
+    bool changed(int slot, const void *value, size_t n) {
+        if (slot < 0) {
+            return false;
+        }
+        Uniform &u = this->uniforms[slot];
+        if (u.valid && memcmp(u.value, value, n * sizeof(float)) == 0) {
+            this->skipped++;
+            return false;
+        }
+        memcpy(u.value, value, n * sizeof(float));
+        u.valid = true;
+        this->uploads++;
+        return true;
+    }
+
+public:
+    // Contadores para medir quantas chamadas ao driver foram evitadas
+    unsigned int uploads; // glUniform* de fato enviados
+    unsigned int skipped; // glUniform* pulados (valor repetido)
+    unsigned int lookups; // buscas por nome resolvidas na tabela (seriam glGetUniformLocation)
+
+    ShaderProgram(GLuint programme = 0) {
+        this->uploads = this->skipped = this->lookups = 0;
+        reflect(programme);
+    }
+
+    // Compila e linka a partir dos arquivos (create_programme_from_files) e já lê as uniforms
+    static ShaderProgram fromFiles(const char *vert_file_name, const char *frag_file_name) {
+        return ShaderProgram(create_programme_from_files(vert_file_name, frag_file_name));
+    }
+
+    // Lê as uniforms ativas de um programa já linkado
+    void reflect(GLuint programme) {
+        this->id = programme;
+        this->uniforms.clear();
+        this->slots.clear();
+        if (!programme) {
+            return;
+        }
+
+        GLint count = 0;
+        glGetProgramiv(programme, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++) {
+            char name[256];
+            GLsizei length = 0;
+            GLint size = 0;
+            Uniform u;
+            glGetActiveUniform(programme, i, sizeof(name), &length, &size, &u.type, name);
+            u.location = glGetUniformLocation(programme, name);
+            u.valid = false;
+            if (u.location < 0) {
+                continue; // uniform de bloco
+            }
+
+            int slot = (int)this->uniforms.size();
+            this->uniforms.push_back(u);
+            this->slots[name] = slot;
+            // arrays aparecem como "nome[0]": aceita também "nome"
+            char *bracket = strchr(name, '[');
+            if (bracket) {
+                *bracket = '\0';
+                this->slots[name] = slot;
+            }
+        }
+    }
+
+    GLuint getId() const {
+        return this->id;
+    }
+
+    void use() const {
+        glUseProgram(this->id);
+    }
+
+    // Slot da uniform (ou -1 se ela não existe/foi otimizada); guarde-o para evitar até o hash
+    int slot(const char *name) {
+        this->lookups++;
+        std::unordered_map<std::string, int>::const_iterator it = this->slots.find(name);
+        return it == this->slots.end() ? -1 : it->second;
+    }
+
+    GLint location(const char *name) {
+        int s = slot(name);
+        return s < 0 ? -1 : this->uniforms[s].location;
+    }
+
+    void setInt(int slot, int v) {
+        if (changed(slot, &v, 1)) glUniform1i(this->uniforms[slot].location, v);
+    }
+    void setFloat(int slot, float v) {
+        if (changed(slot, &v, 1)) glUniform1f(this->uniforms[slot].location, v);
+    }
+    void setVec2(int slot, float x, float y) {
+        float v[] = {x, y};
+        if (changed(slot, v, 2)) glUniform2fv(this->uniforms[slot].location, 1, v);
+    }
+    void setVec4(int slot, float x, float y, float z, float w) {
+        float v[] = {x, y, z, w};
+        if (changed(slot, v, 4)) glUniform4fv(this->uniforms[slot].location, 1, v);
+    }
+    void setMat4(int slot, const float *m) {
+        if (changed(slot, m, 16)) glUniformMatrix4fv(this->uniforms[slot].location, 1, GL_FALSE, m);
+    }
+
+    void setInt(const char *name, int v) { setInt(slot(name), v); }
+    void setFloat(const char *name, float v) { setFloat(slot(name), v); }
+    void setVec2(const char *name, float x, float y) { setVec2(slot(name), x, y); }
+    void setVec4(const char *name, float x, float y, float z, float w) { setVec4(slot(name), x, y, z, w); }
+    void setMat4(const char *name, const float *m) { setMat4(slot(name), m); }
+
+    void resetStats() {
+        this->uploads = this->skipped = this->lookups = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,165 @@
+/******************************************************************************\
+| Triângulos que só crescem (desenhados pelo usuário, por exemplo), guardados  |
+| num buffer da GPU que persiste entre quadros: cada triângulo é enviado uma   |
+| vez, quando é adicionado, e todos são desenhados num único glDrawArrays,     |
+| com a cor em cada vértice. Nenhuma alocação nem envio por quadro.            |
+|                                                                              |
+| Com OpenGL 4.4 (ou ARB_buffer_storage) o buffer é mapeado uma vez, de forma  |
+| persistente e coerente, e add() escreve direto na memória dele. Como só se   |
+| escreve depois do último vértice já desenhado, a GPU nunca está lendo o que  |
+| a CPU escreve: não precisa de cercas nem de orphaning. Sem a extensão, add() |
+| junta os vértices novos na CPU e draw() envia só eles num glBufferSubData.   |
+|                                                                              |
+| Quando enche, a capacidade dobra: buffer novo, cópia na própria GPU          |
+| (glCopyBufferSubData) e o VAO passa a apontar para ele.                      |
+|                                                                              |
+| Atributos: location 0 = vec2 posição, location 1 = vec3 cor.                 |
+\******************************************************************************/
+#ifndef _TRIANGLE_STORE_H_
+#define _TRIANGLE_STORE_H_
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+struct ColorVertex {
+    float x, y;
+    float r, g, b;
+};
+
+class TriangleStore {
+    GLuint vao, vbo;
+    bool persistent;
+    ColorVertex *mapped;                // só no modo persistente
+    std::vector<ColorVertex> pending;   // sem ele: vértices ainda não enviados
+    size_t capacity;                    // vértices
+    size_t count;                       // vértices adicionados
+    size_t uploaded;                    // vértices já na GPU (sem o modo persistente)
+
+    // Buffer de `vertices` vértices, mapeado se persistente
+    GLuint createBuffer(size_t vertices) {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        GLsizeiptr bytes = vertices * sizeof(ColorVertex);
+        if (this->persistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+            this->mapped = (ColorVertex *)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_DYNAMIC_DRAW);
+        }
+        return buffer;
+    }
+
+    void bindAttributes() {
+        glBindVertexArray(this->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ColorVertex), (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ColorVertex), (void *)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Dobra a capacidade até caber `needed` vértices, copiando o que já está na GPU
+    void grow(size_t needed) {
+        size_t capacity = this->capacity;
+        while (capacity < needed)
+            capacity *= 2;
+        size_t onGpu = this->persistent ? this->count : this->uploaded;
+        GLuint old = this->vbo;
+        if (this->persistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, old);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        this->vbo = this->createBuffer(capacity);
+        glBindBuffer(GL_COPY_READ_BUFFER, old);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, onGpu * sizeof(ColorVertex));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &old);
+        this->capacity = capacity;
+        this->bindAttributes();
+    }
+
+public:
+    TriangleStore() {
+        this->vao = this->vbo = 0;
+        this->persistent = false;
+        this->mapped = NULL;
+        this->capacity = this->count = this->uploaded = 0;
+    }
+
+    // Precisa do contexto ainda ativo
+    ~TriangleStore() {
+        if (!this->vao)
+            return;
+        if (this->persistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &this->vbo);
+        glDeleteVertexArrays(1, &this->vao);
+    }
+
+    // Cria o buffer com espaço para `triangles` triângulos; precisa de um
+    // contexto GL ativo. allowPersistent = false força o modo sem mapeamento.
+    void init(size_t triangles = 1024, bool allowPersistent = true) {
+        this->persistent = allowPersistent && (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage);
+        this->capacity = 3 * (triangles > 0 ? triangles : 1);
+        glGenVertexArrays(1, &this->vao);
+        this->vbo = this->createBuffer(this->capacity);
+        this->bindAttributes();
+    }
+
+    bool isPersistent() const {
+        return this->persistent;
+    }
+
+    size_t getTriangles() const {
+        return this->count / 3;
+    }
+
+    void add(const ColorVertex &a, const ColorVertex &b, const ColorVertex &c) {
+        if (this->count + 3 > this->capacity) {
+            // sem o modo persistente, o que está pendente vai junto depois
+            this->grow(this->count + 3);
+        }
+        if (this->persistent) {
+            ColorVertex *dst = this->mapped + this->count;
+            dst[0] = a;
+            dst[1] = b;
+            dst[2] = c;
+        } else {
+            this->pending.push_back(a);
+            this->pending.push_back(b);
+            this->pending.push_back(c);
+        }
+        this->count += 3;
+    }
+
+    // Envia o que está pendente (sem o modo persistente) e desenha todos os
+    // triângulos com o programa em uso
+    void draw() {
+        if (!this->pending.empty()) {
+            glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, this->uploaded * sizeof(ColorVertex),
+                            this->pending.size() * sizeof(ColorVertex), this->pending.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            this->uploaded += this->pending.size();
+            this->pending.clear();
+        }
+        if (!this->count)
+            return;
+        glBindVertexArray(this->vao);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)this->count);
+        glBindVertexArray(0);
+    }
+};
+
+#endif
@@ -13,6 +13,7 @@
 | it is really making life easier.                                             |
 \******************************************************************************/
 #include "gl_utils.h"
+#include "Headless.h"
 
 #include <stdio.h>
 #include <time.h>
@@ -80,11 +81,11 @@ bool gl_log_err (const char* message, ...) {
 }
 
 /*--------------------------------GLFW3 and GLEW------------------------------*/
-bool start_gl () {
+bool start_gl (bool headless) {
 	gl_log ("starting GLFW %s", glfwGetVersionString ());
 	
 	glfwSetErrorCallback (glfw_error_callback);
-	if (!glfwInit ()) {
+	if (headless ? !glfwInitHeadless () : !glfwInit ()) {
 		fprintf (stderr, "ERROR: could not start GLFW3\n");
 		return false;
 	}
@@ -35,7 +35,8 @@ bool gl_log (const char* message, ...);
 /* same as gl_log except also prints to stderr */
 bool gl_log_err (const char* message, ...);
 /*--------------------------------GLFW3 and GLEW------------------------------*/
-bool start_gl ();
+/* headless: janela invisível (ver Headless.h), para rodar sem monitor */
+bool start_gl (bool headless = false);
 void glfw_error_callback (int error, const char* description);
 void glfw_window_size_callback (GLFWwindow* window, int width, int height);
 void _update_fps_counter (GLFWwindow* window);
@@ -0,0 +1,25 @@
+#version 410
+
+in vec2 texture_coords;
+
+uniform sampler2D sprite;
+uniform float offsetx;
+uniform float offsety;
+
+// tile desenhado: vai para o framebuffer de seleção (PickingBuffer.h)
+uniform int tileCol;
+uniform int tileRow;
+uniform int tileLayer;
+
+out uvec4 tile_id;
+
+void main () {
+    // mesmo recorte do _geral_fs.glsl: só conta o que aparece na tela
+    vec4 texel = texture (sprite,
+        vec2(texture_coords.x + offsetx,
+             texture_coords.y + offsety));
+    if(texel.a < 0.5) {
+        discard;
+    }
+    tile_id = uvec4(tileCol, tileRow, tileLayer, 1);
+}
@@ -1,6 +1,7 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "gl_utils.h"
+#include "ShaderProgram.h"
 #include <glad/glad.h> // Carregamento dos ponteiros para funções OpenGL
 #include <GLFW/glfw3.h>
 #include <assert.h>
@@ -14,9 +15,11 @@
 #include <iostream>
 #include <vector>
 #include "TileMap.h"
+#include "BinaryMap.h"
+#include "TmxImporter.h"
 #include "DiamondView.h"
 #include "SlideView.h"
-#include "ltMath.h"
+#include "PickingBuffer.h"
 #include <fstream>
 
 
@@ -39,6 +42,7 @@ int tileSetCols = 9, tileSetRows = 9;
 float tileW, tileW2;
 float tileH, tileH2;
 int cx = -1, cy = -1;
+int hx = -1, hy = -1; // tile sob o mouse, vindo da seleção pela GPU
 
 TilemapView *tview = new DiamondView();
 // TilemapView *tview = new SlideView();
@@ -64,6 +68,39 @@ TileMap * readMap (char *filename) {
     return tmap;
 }
 
+// Mesmo mapa em .tbin (gerado por Ferramentas/ConverteMapa): o arquivo é mapeado
+// em memória e cada linha é copiada de uma vez, sem parsing. NULL se não abrir.
+TileMap * readMapBinary (const char *filename) {
+    BinaryMap bin;
+    string err;
+    if (!bin.open(filename, err)) {
+        cout << err << endl;
+        return NULL;
+    }
+    const BinaryMapHeader &hdr = bin.getHeader();
+    TileMap *tmap = new TileMap(hdr.cols, hdr.rows, 0);
+    for(int r = 0; r < hdr.rows; r++) {
+        // linhas invertidas, como em readMap
+        memcpy(tmap->getMap() + (hdr.rows - r - 1) * hdr.cols, bin.getTiles() + r * hdr.cols, hdr.cols);
+    }
+    return tmap;
+}
+
+// Direto do .tmx exportado pelo Tiled (primeira camada), sem converter para .tmap.
+// flipY deixa as linhas na mesma ordem de readMap. NULL se não abrir.
+TileMap * readMapTmx (const char *filename) {
+    vector<TmxTileLayer> camadas;
+    TmxMapInfo info;
+    string err;
+    if (!TmxImporter::loadTileMaps(filename, camadas, info, err, true)) {
+        cout << err << endl;
+        return NULL;
+    }
+    for (size_t i = 1; i < camadas.size(); i++)
+        delete camadas[i].tiles;
+    return camadas.empty() ? NULL : camadas[0].tiles;
+}
+
 int loadTexture(unsigned int &texture, char *filename)
 {
 	glGenTextures(1, &texture);
@@ -109,76 +146,18 @@ void SRD2SRU(double &mx, double &my, float &x, float &y) {
 }
 
 void mouse(double &mx, double &my) {
+    float x = 0, y = 0;
+    SRD2SRU(mx, my, x, y);
 
-	// cout << "DEBUG => mouse click" << endl;
-    
-    // 1) Definição do tile candidato ao clique
-    float y = 0;
-    float x = 0;
-	SRD2SRU(mx, my, x, y);
-    
+    // O tile (c, r) é desenhado com o canto em (xi + x, y), com (x, y) de
+    // computeDrawPosition: tirando o xi, o ponto fica no espaço do picker
     int c, r;
-    tview->computeMouseMap(c, r, tw, th, x, y);
-	c += (tmap->getWidth()-1) / 2;
-	r += (tmap->getHeight()-1) / 2;
-	// cout << "\tDEBUG => r: " << r << " c: " << c << endl;
-    
-    // 2) Verificar se o ponto pertence ao tile indicado:
-    
-    // 2.1) Normalização do clique:
-    float x0, y0;
-    tview->computeDrawPosition(c, r, tw, th, x0, y0);
-    x0 += xi;
-
-	// cout << "\tDEBUG => mx: " << x  << " my: " << y  << endl;
-	// cout << "\tDEBUG => x0: " << x0 << " y0: " << y0 << endl;
-	// cout << "\tDEBUG => tw: " << tw << endl;
-
-    float point[] = {x, y};
-    
-    // 2.2) Verifica se o ponto está dentro do triângulo da esquerda ou da direita do losangulo (metades)
-    //      Implementação via cálculo de área dos triangulos: area(ABC) == area(ABp)+area(ACp)+area(BCp)
-    // triangulo ABC:
-    float *abc = new float[6];
-    
-    // 2.2.1) Define metade da esquerda ou da direita
-    bool left = x < (x0 + tw/2.0f);
-	// cout << "\tDEBUG => mx: " << x << " midx: " << (x0 + tw/2.0f) << endl; 
-
-    if(left){ // left
-        abc[0] = x0;           abc[1] = y0 + th/2.0f;
-        abc[2] = x0 + tw/2.0f; abc[3] = y0 + th;
-        abc[4] = x0 + tw/2.0f; abc[5] = y0;
-        // cout << "DEBUG => TRG LFT [(x,y),...] = ([" << abc[0] << "," << abc[1] << "], "
-        // << "[" << abc[2] << "," << abc[3] << "], "
-        // << "[" << abc[4] << "," << abc[5] << "])" << endl;
-    } else { // right
-        abc[0] = x0 + tw/2.0f; abc[1] = y0;
-        abc[2] = x0 + tw/2.0f; abc[3] = y0 + th;
-        abc[4] = x0 + tw;      abc[5] = y0 + th/2.0f;
-	    // cout << "DEBUG => TRG RGHT [(x,y),...] = ([" << abc[0] << "," << abc[1] << "], "
-        // << "[" << abc[2] << "," << abc[3] << "], "
-        // << "[" << abc[4] << "," << abc[5] << "])" << endl;
-    }
-    
-    // 2.3) Calcular colisão do ponto com o triangulo
-   bool collide = triangleCollidePoint2D(abc, point);
-    
-    if(!collide){
-        // 2.4) Em caso "erro" de cálculo, deve ser feito o tileWalking para tile certo!
-        cout << "tileWalking " << endl;
-		if(left){
-			tview->computeTileWalking(c, r, DIRECTION_WEST);
-		} else {
-			tview->computeTileWalking(c, r, DIRECTION_EAST);
-		}
-    }
-    
-    if((c < 0) || (c >= tmap->getWidth()) || (r < 0) || (r >= tmap->getHeight())){
+    TilePicker picker = tview->getPicker(tw, th, tmap->getWidth(), tmap->getHeight());
+    if (!picker.pick(x - xi, y, c, r)) {
         cout << "wrong click position: " << c << ", " << r << endl;
         return; // posição inválida!
     }
-    
+
     cout << "SELECIONADO c=" << c << "," << r << endl;
     cx = c; cy = r;
 }
@@ -193,7 +172,11 @@ int main()
 	glDepthFunc(GL_LESS);
 
     cout << "Tentando criar tmap" << endl;
-    tmap = readMap("terrain1.tmap");
+    tmap = readMapBinary("terrain1.tbin");
+    if (!tmap)
+        tmap = readMapTmx("terrain1.tmx");
+    if (!tmap)
+        tmap = readMap("terrain1.tmap");
     tw = w / (float)tmap->getWidth();
     th = tw / 2.0f;
     tw2 = th;
@@ -298,6 +281,34 @@ int main()
 		return false;
 	}
 
+	// Tabela de uniforms: nada de glGetUniformLocation no laço, e valores repetidos
+	// (layer_z, sprite, weight quase sempre 0) não são reenviados
+	ShaderProgram programa(shader_programme);
+	int uOffsetx = programa.slot("offsetx");
+	int uOffsety = programa.slot("offsety");
+	int uTx = programa.slot("tx");
+	int uTy = programa.slot("ty");
+	int uLayerZ = programa.slot("layer_z");
+	int uWeight = programa.slot("weight");
+	int uSprite = programa.slot("sprite");
+
+	// Seleção pela GPU (tecla P liga/desliga): os tiles são desenhados de novo
+	// num framebuffer de inteiros, com (col, row, camada) no lugar da cor, e o
+	// pixel sob o mouse volta um quadro depois. Desligada, o clique usa mouse().
+	ShaderProgram picking = ShaderProgram::fromFiles("_geral_vs.glsl", "_picking_fs.glsl");
+	int pOffsetx = picking.slot("offsetx");
+	int pOffsety = picking.slot("offsety");
+	int pTx = picking.slot("tx");
+	int pTy = picking.slot("ty");
+	int pLayerZ = picking.slot("layer_z");
+	int pSprite = picking.slot("sprite");
+	int pCol = picking.slot("tileCol");
+	int pRow = picking.slot("tileRow");
+	int pLayer = picking.slot("tileLayer");
+	PickingBuffer *pickingBuffer = new PickingBuffer();
+	bool usarPicking = true;
+	bool teclaP = false, botao = false;
+
 	float previous = glfwGetTime();
     
     
@@ -312,6 +323,7 @@ int main()
 	glEnable (GL_BLEND);
 	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	// glEnable(GL_DEPTH_TEST);
+	vector<TileSpan> spans; // tiles visíveis do quadro; a capacidade fica para o próximo
 	while (!glfwWindowShouldClose(g_window))
 	{
 		_update_fps_counter(g_window);
@@ -324,35 +336,71 @@ int main()
 
 		glViewport(0, 0, g_gl_width, g_gl_height);
 
-		glUseProgram(shader_programme);
+		programa.use();
+		glBindTexture(GL_TEXTURE_2D, tmap->getTileSet());
+		programa.setInt(uSprite, 0);
+		programa.setFloat(uLayerZ, tmap->getZ());
 
 		glBindVertexArray(VAO);
         float x, y;
-        int r = 0, c = 0;
-        for(int r = 0; r < tmap->getHeight(); r++) {
-            for(int c = 0; c < tmap->getWidth(); c++) {
+
+        // Só os tiles que aparecem na tela: a câmera é o SRU [-1, 1] x [-1, 1], e o tile (c, r)
+        // fica em xi + x (os vértices já incluem xi e yi, e ty = y + 1 cancela o yi)
+        tview->computeVisibleSpans(tw, th, -1.0f - xi, -1.0f, 1.0f - xi, 1.0f,
+                                   tmap->getWidth(), tmap->getHeight(), spans);
+        for(const TileSpan &span : spans) {
+            int r = span.row;
+            for(int c = span.colBegin; c < span.colEnd; c++) {
                 int t_id = (int) tmap->getTile(c, r);
                 int u = t_id % tileSetCols;
                 int v = t_id / tileSetCols;
                                 
                 tview->computeDrawPosition(c, r, tw, th, x, y);
                 
-                glUniform1f(glGetUniformLocation(shader_programme, "offsetx"), u * tileW);
-                glUniform1f(glGetUniformLocation(shader_programme, "offsety"), v * tileH);
-                glUniform1f(glGetUniformLocation(shader_programme, "tx"), x);
-                glUniform1f(glGetUniformLocation(shader_programme, "ty"), y + 1.0);
-                glUniform1f(glGetUniformLocation(shader_programme, "layer_z"), tmap->getZ());                
-                glUniform1f(glGetUniformLocation(shader_programme, "weight"), (c == cx) && (r == cy) ? 0.5 : 0.0);                
-                
-                // bind Texture
-                // glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, tmap->getTileSet());
-                glUniform1i(glGetUniformLocation(shader_programme, "sprite"), 0);
+                programa.setFloat(uOffsetx, u * tileW);
+                programa.setFloat(uOffsety, v * tileH);
+                programa.setFloat(uTx, x);
+                programa.setFloat(uTy, y + 1.0);
+                float weight = (c == cx) && (r == cy) ? 0.5 : ((c == hx) && (r == hy) ? 0.25 : 0.0);
+                programa.setFloat(uWeight, weight);
                 glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
             }
             
         }
 
+        double mx, my;
+        glfwGetCursorPos(g_window, &mx, &my);
+
+        if (usarPicking) {
+            pickingBuffer->resize(g_gl_width, g_gl_height);
+            pickingBuffer->begin();
+            picking.use();
+            picking.setInt(pSprite, 0);
+            picking.setFloat(pLayerZ, tmap->getZ());
+            picking.setInt(pLayer, 0);
+            for(const TileSpan &span : spans) {
+                int r = span.row;
+                for(int c = span.colBegin; c < span.colEnd; c++) {
+                    int t_id = (int) tmap->getTile(c, r);
+                    tview->computeDrawPosition(c, r, tw, th, x, y);
+                    picking.setFloat(pOffsetx, (t_id % tileSetCols) * tileW);
+                    picking.setFloat(pOffsety, (t_id / tileSetCols) * tileH);
+                    picking.setFloat(pTx, x);
+                    picking.setFloat(pTy, y + 1.0);
+                    picking.setInt(pCol, c);
+                    picking.setInt(pRow, r);
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                }
+            }
+            pickingBuffer->end(mx, my);
+
+            PickResult sob;
+            if (pickingBuffer->poll(sob)) {
+                hx = sob.hit ? sob.col : -1;
+                hy = sob.hit ? sob.row : -1;
+            }
+        }
+
 		glfwPollEvents();
 		if (GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_ESCAPE))
 		{
@@ -364,19 +412,31 @@ int main()
 		if (GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_DOWN))
 		{
 		}
-        double mx, my;
-        glfwGetCursorPos(g_window, &mx, &my);
-        
+        bool p = GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_P);
+        if (p && !teclaP) {
+            usarPicking = !usarPicking;
+            hx = hy = -1;
+            cout << "Seleção pela GPU " << (usarPicking ? "ligada" : "desligada") << endl;
+        }
+        teclaP = p;
+
+        // Só no quadro em que o botão é apertado, não enquanto fica pressionado
         const int state = glfwGetMouseButton(g_window, GLFW_MOUSE_BUTTON_LEFT);
-        
-        if (state == GLFW_PRESS) {
-            mouse(mx, my);
+        if (state == GLFW_PRESS && !botao) {
+            if (!usarPicking) {
+                mouse(mx, my);
+            } else if (hx >= 0) {
+                cout << "SELECIONADO c=" << hx << "," << hy << endl;
+                cx = hx; cy = hy;
+            }
         }
+        botao = state == GLFW_PRESS;
         
 		// put the stuff we've been drawing onto the display
 		glfwSwapBuffers(g_window);
 	}
 
+	delete pickingBuffer; // antes do glfwTerminate: apaga objetos do contexto
 	// close GL context and any other GLFW resources
 	glfwTerminate();
     delete tmap;
@@ -0,0 +1,261 @@
+/*
+ * BenchAnimacao - confere e mede common/M5-6/RotationTracks.h e
+ * common/M5-6/SpriteAnimator.h
+ *
+ * Uso:
+ *   BenchAnimacao [trilhas [atores]]
+ *       cria `trilhas` trilhas de rotação (padrão: 10000), cada uma com 8
+ *       quadros-chave em eixos e tempos sorteados e uma fase própria, e anima
+ *       600 quadros a 60 quadros por segundo:
+ *        - com RotationTracks::sample, por nlerp e por slerp;
+ *        - objeto a objeto, com o slerp do maths_funcs e busca do segmento
+ *          a cada amostra (o jeito de antes);
+ *        - com RotationTracks, mas em tempos sorteados (sem o cursor ajudar).
+ *       Confere que o slerp em lote dá a mesma rotação que o do maths_funcs,
+ *       e o nlerp quase a mesma.
+ *
+ *       Depois anima `atores` sprites (padrão: 100000) com clipes loop, once e
+ *       pingpong, com o SpriteAnimator e com um contador de quadro por ator
+ *       (como o Trabfinal fazia), e confere o quadro de cada ator contra a
+ *       conta direta a partir do tempo total.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "RotationTracks.h"
+#include "SpriteAnimator.h"
+#include "maths_funcs.h"
+
+using namespace std;
+
+const int CHAVES = 8;
+const int QUADROS = 600;
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t sortear(uint32_t &x)
+{
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+float sortearFloat(uint32_t &x)
+{
+	return (sortear(x) % 20001) / 10000.0f - 1.0f;
+}
+
+struct Trilha
+{
+	float tempos[CHAVES];
+	versor chaves[CHAVES];
+	float fase;
+};
+
+// Referência: acha o segmento do zero e interpola com o slerp do maths_funcs
+versor amostrar(const Trilha &t, float tempo)
+{
+	float t0 = t.tempos[0], t1 = t.tempos[CHAVES - 1];
+	tempo = fmod(tempo - t0, t1 - t0);
+	tempo = (tempo < 0.0f ? tempo + (t1 - t0) : tempo) + t0;
+	int s = 0;
+	while (s < CHAVES - 2 && t.tempos[s + 1] <= tempo)
+		s++;
+	float u = (tempo - t.tempos[s]) / (t.tempos[s + 1] - t.tempos[s]);
+	return slerp(t.chaves[s], t.chaves[s + 1], u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u));
+}
+
+// Maior ângulo (graus) entre a referência e o lote, como rotações (q ~ -q).
+// Pela distância entre os quaternions, e não pelo acos do produto escalar,
+// que perde a precisão perto de 1.
+double maiorDiferenca(const vector<Trilha> &trilhas, const vector<float> &tempos, const RotationTracks &rt)
+{
+	double pior = 0.0;
+	for (size_t k = 0; k < trilhas.size(); k++)
+	{
+		versor r = amostrar(trilhas[k], tempos[k]);
+		double lote[4] = {rt.getW()[k], rt.getX()[k], rt.getY()[k], rt.getZ()[k]};
+		double d = 0.0, dist = 0.0;
+		for (int i = 0; i < 4; i++)
+			d += r.q[i] * lote[i];
+		for (int i = 0; i < 4; i++)
+		{
+			double c = r.q[i] - (d < 0.0 ? -lote[i] : lote[i]);
+			dist += c * c;
+		}
+		pior = max(pior, 4.0 * asin(min(1.0, sqrt(dist) / 2.0)) * 180.0 / acos(-1.0));
+	}
+	return pior;
+}
+
+// Ator do jeito antigo: contador de tempo e de quadro, com um if por modo
+struct AtorAntigo
+{
+	int primeiro, ultimo, quadro, passo;
+	float tempoQuadro, duracaoQuadro;
+	AnimLoop modo;
+};
+
+// Quadro (coluna) do clipe c depois de t segundos, pela conta direta
+int quadroEsperado(const AnimationClip &c, double t)
+{
+	int n = c.last - c.first + 1;
+	long long f = (long long)floor(t * c.fps + 1e-4);
+	if (c.mode == ANIM_ONCE)
+		return c.first + (int)min<long long>(f, n - 1);
+	if (c.mode == ANIM_PINGPONG && n > 1)
+	{
+		int p = 2 * n - 2;
+		f %= p;
+		return c.first + (int)(f < n ? f : p - f);
+	}
+	return c.first + (int)(f % n);
+}
+
+int sprites(int atores)
+{
+	vector<AnimationClip> clipes = {
+		{"anda", "folha", 8, 4, 0, 0, 7, 12.0f, ANIM_LOOP},
+		{"pula", "folha", 8, 4, 1, 2, 6, 10.0f, ANIM_ONCE},
+		{"respira", "folha", 8, 4, 2, 0, 4, 6.0f, ANIM_PINGPONG},
+		{"parado", "folha", 8, 4, 3, 5, 5, 1.0f, ANIM_LOOP},
+	};
+	SpriteAnimator animador(clipes);
+	vector<AtorAntigo> antigos(atores);
+	for (int k = 0; k < atores; k++)
+	{
+		int c = k % (int)clipes.size();
+		animador.add(c);
+		antigos[k] = {clipes[c].first, clipes[c].last, clipes[c].first, 1, 0.0f, 1.0f / clipes[c].fps, clipes[c].mode};
+	}
+
+	// 1/64 s: exato em float, para a conta direta dar o mesmo quadro
+	const float dt = 1.0f / 64.0f;
+	double t0 = agora();
+	for (int q = 0; q < QUADROS; q++)
+		animador.update(dt);
+	double tAnimador = (agora() - t0) / QUADROS;
+
+	t0 = agora();
+	for (int q = 0; q < QUADROS; q++)
+		for (AtorAntigo &a : antigos)
+		{
+			a.tempoQuadro += dt;
+			if (a.tempoQuadro < a.duracaoQuadro)
+				continue;
+			a.tempoQuadro -= a.duracaoQuadro;
+			if (a.modo == ANIM_ONCE)
+				a.quadro = min(a.quadro + 1, a.ultimo);
+			else if (a.modo == ANIM_PINGPONG && a.ultimo > a.primeiro)
+			{
+				if (a.quadro + a.passo < a.primeiro || a.quadro + a.passo > a.ultimo)
+					a.passo = -a.passo;
+				a.quadro += a.passo;
+			}
+			else
+				a.quadro = a.quadro < a.ultimo ? a.quadro + 1 : a.primeiro;
+		}
+	double tAntigo = (agora() - t0) / QUADROS;
+
+	int erros = 0;
+	for (int k = 0; k < atores; k++)
+		if (animador.getColumn()[k] != quadroEsperado(clipes[k % clipes.size()], QUADROS * (double)dt))
+			erros++;
+	printf("\n%d sprites animados, %d quadros: %s\n", atores, QUADROS, erros ? "QUADROS ERRADOS" : "quadros ok");
+	printf("  SpriteAnimator::update      %8.3f ms por quadro\n", tAnimador * 1e3);
+	printf("  contador por ator           %8.3f ms por quadro  (soma %d)\n", tAntigo * 1e3, antigos[atores / 2].quadro);
+	return erros;
+}
+
+int main(int argc, char **argv)
+{
+	int n = 10000, atores = 100000;
+	if (argc > 3 || (argc >= 2 && (n = atoi(argv[1])) <= 0) || (argc == 3 && (atores = atoi(argv[2])) <= 0))
+	{
+		fprintf(stderr, "Uso: %s [trilhas [atores]]\n", argv[0]);
+		return -1;
+	}
+
+	uint32_t x = 1234;
+	vector<Trilha> trilhas(n);
+	RotationTracks rt;
+	for (Trilha &t : trilhas)
+	{
+		float tempo = 0.0f;
+		float q[4 * CHAVES];
+		for (int c = 0; c < CHAVES; c++)
+		{
+			t.tempos[c] = tempo;
+			tempo += 0.2f + (sortear(x) % 1000) / 500.0f;
+			vec3 eixo = normalise(vec3(sortearFloat(x), sortearFloat(x), sortearFloat(x) + 0.01f));
+			t.chaves[c] = quat_from_axis_deg(sortearFloat(x) * 180.0f, eixo.v[0], eixo.v[1], eixo.v[2]);
+			for (int i = 0; i < 4; i++)
+				q[4 * c + i] = t.chaves[c].q[i];
+		}
+		t.fase = (sortear(x) % 1000) / 100.0f;
+		rt.addTrack(t.tempos, q, CHAVES);
+	}
+
+	// Conferência, num quadro qualquer
+	vector<float> tempos(n);
+	for (int k = 0; k < n; k++)
+		tempos[k] = 3.7f + trilhas[k].fase;
+	rt.sample(tempos.data(), ROTATION_SLERP);
+	double difSlerp = maiorDiferenca(trilhas, tempos, rt);
+	rt.sample(tempos.data(), ROTATION_NLERP);
+	double difNlerp = maiorDiferenca(trilhas, tempos, rt);
+	bool ok = difSlerp < 0.01;
+	printf("%d trilhas de %d quadros-chave\n", n, CHAVES);
+	printf("conferência com o slerp do maths_funcs: slerp até %.4f graus (%s), nlerp até %.2f graus\n", difSlerp,
+		   ok ? "ok" : "DIFERENTE", difNlerp);
+
+	// Velocidade: QUADROS quadros seguidos
+	double soma = 0.0;
+	auto animar = [&](RotationInterp interp) {
+		double t0 = agora();
+		for (int q = 0; q < QUADROS; q++)
+		{
+			for (int k = 0; k < n; k++)
+				tempos[k] = q / 60.0f + trilhas[k].fase;
+			rt.sample(tempos.data(), interp);
+			soma += rt.getW()[q % n];
+		}
+		return (agora() - t0) / QUADROS;
+	};
+	double tNlerp = animar(ROTATION_NLERP);
+	double tSlerp = animar(ROTATION_SLERP);
+
+	double t0 = agora();
+	for (int q = 0; q < QUADROS; q++)
+		for (int k = 0; k < n; k++)
+			soma += amostrar(trilhas[k], q / 60.0f + trilhas[k].fase).q[0];
+	double tObjeto = (agora() - t0) / QUADROS;
+
+	t0 = agora();
+	for (int q = 0; q < QUADROS; q++)
+	{
+		for (int k = 0; k < n; k++)
+			tempos[k] = (sortear(x) % 100000) / 1000.0f;
+		rt.sample(tempos.data(), ROTATION_SLERP);
+		soma += rt.getW()[q % n];
+	}
+	double tAleatorio = (agora() - t0) / QUADROS;
+
+	printf("\nms por quadro (todas as trilhas):\n");
+	printf("  lote, nlerp                    %8.3f\n", tNlerp * 1e3);
+	printf("  lote, slerp                    %8.3f\n", tSlerp * 1e3);
+	printf("  objeto a objeto, maths_funcs   %8.3f  (%.1fx o lote com slerp)\n", tObjeto * 1e3, tObjeto / tSlerp);
+	printf("  lote, slerp, tempos sorteados  %8.3f  (sem o cursor)\n", tAleatorio * 1e3);
+	printf("  (soma %g)\n", soma);
+
+	int errosSprites = sprites(atores);
+	return ok && !errosSprites ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/*
+ * BenchCaminhos - mede o A* e o flow field de common/M5-6/Pathfinding.h
+ *
+ * Uso:
+ *   BenchCaminhos [--threads T] [N...]
+ *       gera mapas NxN (padrão: 1024 4096) com 25% de tiles bloqueados e
+ *       muros com passagens, e mede:
+ *        - A*: 1000 buscas entre tiles sorteados a até 128 tiles um do outro
+ *          (um agente indo a um lugar próximo), e as mesmas de novo (cache);
+ *        - flow field até o centro com 1, 2, 4... até T threads (padrão:
+ *          número de núcleos);
+ *       e confere que o A* e o flow field dão o mesmo número de passos.
+ *
+ * Antes, se achar o mapa do Trabfinal (rode de dentro de build/), procura o
+ * caminho do início até cada moeda.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Modulo6/Jogo.h"
+#include "IsometricView.h"
+#include "Pathfinding.h"
+
+using namespace std;
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t sortear(uint32_t &x)
+{
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+// 25% de tiles bloqueados soltos e, a cada 64 linhas, um muro com uma
+// passagem a cada 256 colunas
+vector<unsigned char> gerarMapa(int n)
+{
+	vector<unsigned char> grade((size_t)n * n);
+	uint32_t x = 2024;
+	for (size_t i = 0; i < grade.size(); i++)
+		grade[i] = sortear(x) % 4 != 0;
+	for (int row = 32; row < n; row += 64)
+		for (int col = 0; col < n; col++)
+			grade[(size_t)row * n + col] = col % 256 == 128;
+	grade[(size_t)(n / 2) * n + n / 2] = 1;
+	return grade;
+}
+
+void mapaDoJogo()
+{
+	MapConfig cfg;
+	vector<TileType> tileTypes;
+	string err;
+	if (!loadMap("../src/Modulo6/config/tileMap.txt", "../src/Modulo6/config/tileProps.txt",
+				 "../src/Modulo6/config/tileMap.tbin", cfg, tileTypes, err))
+		return;
+	Jogo jogo(cfg, tileTypes);
+	vector<unsigned char> grade;
+	jogo.gradeCaminhavel(grade);
+	IsometricView view;
+	PathGrid pathGrid(cfg.rows, cfg.cols, grade.data(), view);
+	AStar astar(pathGrid);
+
+	const EstadoJogo &e = jogo.estado();
+	printf("Mapa do Trabfinal (%dx%d), do início (%d, %d) até cada moeda:\n", cfg.rows, cfg.cols, e.player_i, e.player_j);
+	vector<int> caminho;
+	for (const Moeda &m : e.moedas)
+	{
+		if (astar.findPath(e.player_j, e.player_i, m.j, m.i, caminho))
+			printf("  (%d, %d): %zu passos\n", m.i, m.j, caminho.size());
+		else
+			printf("  (%d, %d): sem caminho\n", m.i, m.j);
+	}
+	printf("\n");
+}
+
+int benchmark(int n, int maxThreads)
+{
+	vector<unsigned char> grade = gerarMapa(n);
+	IsometricView view;
+	PathGrid pathGrid(n, n, grade.data(), view);
+
+	// A*: pares de tiles caminháveis, o segundo a até 128 tiles do primeiro
+	const int BUSCAS = 1000;
+	vector<int> pares;
+	uint32_t x = 7;
+	while ((int)pares.size() < 4 * BUSCAS)
+	{
+		int col = sortear(x) % n, row = sortear(x) % n;
+		if (pares.size() % 4 == 2)
+		{
+			col = pares[pares.size() - 2] + (int)(sortear(x) % 257) - 128;
+			row = pares[pares.size() - 1] + (int)(sortear(x) % 257) - 128;
+		}
+		if (pathGrid.passable(col, row))
+		{
+			pares.push_back(col);
+			pares.push_back(row);
+		}
+	}
+	AStar astar(pathGrid, BUSCAS);
+	vector<int> caminho;
+	size_t passos = 0;
+	int achados = 0;
+	double t0 = agora();
+	for (int k = 0; k < BUSCAS; k++)
+	{
+		const int *p = &pares[4 * k];
+		if (astar.findPath(p[0], p[1], p[2], p[3], caminho))
+		{
+			achados++;
+			passos += caminho.size();
+		}
+	}
+	double tFrio = agora() - t0;
+	size_t expandidos = astar.getExpanded();
+	t0 = agora();
+	for (int k = 0; k < BUSCAS; k++)
+	{
+		const int *p = &pares[4 * k];
+		astar.findPath(p[0], p[1], p[2], p[3], caminho);
+	}
+	double tCache = agora() - t0;
+
+	printf("%dx%d\n", n, n);
+	printf("  A*: %d buscas, %d com caminho (média %.0f passos, %.0f tiles expandidos)\n", BUSCAS, achados,
+		   achados ? (double)passos / achados : 0.0, (double)expandidos / BUSCAS);
+	printf("      %.3f ms por busca, %.4f ms repetindo (cache)\n", tFrio * 1e3 / BUSCAS, tCache * 1e3 / BUSCAS);
+
+	// Flow field até o centro: melhor de 3 para cada número de threads
+	int centro = n / 2;
+	vector<int> nThreads;
+	for (int T = 1; T < maxThreads; T *= 2)
+		nThreads.push_back(T);
+	nThreads.push_back(maxThreads);
+	double tUma = 0;
+	for (int T : nThreads)
+	{
+		FlowField campo(pathGrid, T);
+		double melhor = 1e30;
+		for (int k = 0; k < 3; k++)
+		{
+			t0 = agora();
+			campo.build(centro, centro);
+			melhor = min(melhor, agora() - t0);
+		}
+		if (T == 1)
+			tUma = melhor;
+		printf("  flow field, %2d thread(s): %8.2f ms  (%.2fx)\n", T, melhor * 1e3, tUma / melhor);
+	}
+
+	// Conferência: distância do campo = tamanho do caminho do A*, e seguir o
+	// campo chega ao centro nesse mesmo número de passos
+	FlowField campo(pathGrid, maxThreads);
+	campo.build(centro, centro);
+	int erros = 0;
+	for (int k = 0; k < 20; k++)
+	{
+		int col = pares[4 * k], row = pares[4 * k + 1];
+		bool achou = astar.findPath(col, row, centro, centro, caminho);
+		uint32_t d = campo.getDistance(col, row);
+		if (achou != (d != PATH_UNREACHABLE) || (achou && d != caminho.size()))
+			erros++;
+		uint32_t andados = 0;
+		while (campo.step(col, row))
+			andados++;
+		if (achou && (andados != d || col != centro || row != centro))
+			erros++;
+	}
+	printf("  conferência A* x flow field: %s\n\n", erros ? "DIFERENTES" : "ok");
+	return erros ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	int maxThreads = max(1, (int)thread::hardware_concurrency());
+	vector<int> tamanhos;
+	for (int i = 1; i < argc; i++)
+	{
+		if (string(argv[i]) == "--threads" && i + 1 < argc)
+			maxThreads = max(1, atoi(argv[++i]));
+		else if (atoi(argv[i]) > 0)
+			tamanhos.push_back(atoi(argv[i]));
+		else
+		{
+			cerr << "Uso: " << argv[0] << " [--threads T] [N...]" << endl;
+			return -1;
+		}
+	}
+	if (tamanhos.empty())
+		tamanhos = {1024, 4096};
+
+	mapaDoJogo();
+	int retorno = 0;
+	for (int n : tamanhos)
+		retorno |= benchmark(n, maxThreads);
+	return retorno;
+}
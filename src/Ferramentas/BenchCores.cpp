@@ -0,0 +1,142 @@
+/*
+ * BenchCores - confere e mede common/ColorIndex.h, o índice de cores do
+ * Modulo3/M3JogoCores
+ *
+ * Uso:
+ *   BenchCores [celulas]
+ *       sorteia `celulas` cores (padrão: 1M) e joga uma partida inteira como
+ *       o M3JogoCores: a cada clique, numa célula viva sorteada, elimina ela
+ *       e todas as vivas a até 0.2 * sqrt(3) dela. Cada clique é feito com o
+ *       ColorIndex e com a varredura de todas as células (o jeito de antes),
+ *       e as duas têm de eliminar as mesmas células. Mostra o tempo médio e o
+ *       pior por clique, e o da verificação de fim de jogo que varria a grade
+ *       a cada quadro, contra o contador de células vivas.
+ *
+ * A varredura usa o mesmo teste do índice (distância ao quadrado contra o
+ * raio ao quadrado), para a conferência não depender de arredondamento.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ColorIndex.h"
+
+using namespace std;
+
+const float TOLERANCIA = 0.2f;
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t sortear(uint32_t &x)
+{
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+struct Cor
+{
+	float r, g, b;
+};
+
+// Como o verificarFimDoJogo antigo: para na primeira célula viva
+bool fimPorVarredura(const vector<int> &eliminada)
+{
+	for (size_t i = 0; i < eliminada.size(); i++)
+		if (!eliminada[i])
+			return false;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	int n = 1000000;
+	if (argc > 2 || (argc == 2 && (n = atoi(argv[1])) <= 0))
+	{
+		fprintf(stderr, "Uso: %s [celulas]\n", argv[0]);
+		return -1;
+	}
+
+	uint32_t x = 2024;
+	vector<Cor> cores(n);
+	for (Cor &c : cores)
+	{
+		c.r = (sortear(x) % 256) / 255.0f;
+		c.g = (sortear(x) % 256) / 255.0f;
+		c.b = (sortear(x) % 256) / 255.0f;
+	}
+
+	float raio = TOLERANCIA * sqrt(3.0f), raio2 = raio * raio;
+	double t0 = agora();
+	ColorIndex indice(raio);
+	for (int i = 0; i < n; i++)
+		indice.insert(i, cores[i].r, cores[i].g, cores[i].b);
+	double tMontar = agora() - t0;
+
+	vector<int> eliminada(n, 0); // clique que eliminou a célula (0: viva)
+	vector<int> achadas, referencia;
+	int cliques = 0, erros = 0, vivos = n;
+	double tIndice = 0.0, piorIndice = 0.0, tVarredura = 0.0, tFim = 0.0;
+	bool fim = false;
+	while (vivos > 0)
+	{
+		int c;
+		do
+			c = sortear(x) % n;
+		while (eliminada[c]);
+		cliques++;
+
+		// Com o índice
+		t0 = agora();
+		indice.remove(c);
+		achadas.clear();
+		achadas.push_back(c);
+		indice.removeWithin(cores[c].r, cores[c].g, cores[c].b, raio, achadas);
+		double t = agora() - t0;
+		tIndice += t;
+		piorIndice = max(piorIndice, t);
+
+		// Varrendo tudo
+		t0 = agora();
+		referencia.clear();
+		for (int i = 0; i < n; i++)
+		{
+			float dr = cores[i].r - cores[c].r, dg = cores[i].g - cores[c].g, db = cores[i].b - cores[c].b;
+			if (!eliminada[i] && (i == c || dr * dr + dg * dg + db * db <= raio2))
+				referencia.push_back(i);
+		}
+		tVarredura += agora() - t0;
+
+		if (achadas.size() != referencia.size())
+			erros++;
+		for (int i : referencia)
+			eliminada[i] = cliques;
+		for (int i : achadas)
+			if (eliminada[i] != cliques)
+				erros++;
+		vivos -= (int)referencia.size();
+
+		t0 = agora();
+		fim = fimPorVarredura(eliminada);
+		tFim += agora() - t0;
+	}
+	if (!fim || indice.size() != 0)
+		erros++;
+
+	printf("%d células, %d cliques até o fim: %s\n", n, cliques, erros ? "ELIMINAÇÕES DIFERENTES" : "mesmas eliminações");
+	printf("  montar o índice           %10.3f ms\n", tMontar * 1e3);
+	printf("  clique, ColorIndex        %10.3f µs (média)  %10.3f µs (pior)\n", tIndice / cliques * 1e6,
+		   piorIndice * 1e6);
+	printf("  clique, varredura         %10.3f µs (média)  (%.0fx)\n", tVarredura / cliques * 1e6,
+		   tVarredura / tIndice);
+	printf("  fim de jogo, varredura    %10.3f µs por quadro (média nos cliques); contador: 1 comparação\n",
+		   tFim / cliques * 1e6);
+	return erros ? 1 : 0;
+}
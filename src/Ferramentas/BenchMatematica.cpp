@@ -0,0 +1,221 @@
+/*
+ * BenchMatematica - confere e mede as funções de common/M5-6/maths_funcs.cpp
+ *
+ * Uso:
+ *   BenchMatematica [pontos]
+ *       confere as versões SIMD (mat4 x mat4, mat4 x vec4, inverse, transpose
+ *       e transform_points_soa) contra as versões em C++ puro, em 10000
+ *       matrizes sorteadas, e depois mede as três lado a lado: SIMD, C++ puro
+ *       e GLM. O lote transforma `pontos` posições (padrão: 1M) guardadas em
+ *       arrays separados de x e y, como sprites e tiles 2D; a GLM faz o mesmo
+ *       com um array de glm::vec4.
+ *
+ * Compile com otimização (-O2 / Release): sem ela as medidas não dizem nada.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "maths_funcs.h"
+
+using namespace std;
+
+const int MATRIZES = 10000;
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t sortear(uint32_t &x)
+{
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+// Entre -1 e 1
+float sortearFloat(uint32_t &x)
+{
+	return (sortear(x) % 20001) / 10000.0f - 1.0f;
+}
+
+// Matriz bem condicionada (diagonal dominante), para a inversa ser comparável
+mat4 sortearMatriz(uint32_t &x)
+{
+	mat4 m;
+	for (int k = 0; k < 16; k++)
+		m.m[k] = sortearFloat(x);
+	for (int k = 0; k < 4; k++)
+		m.m[k * 5] += 4.0f * (m.m[k * 5] < 0 ? -1.0f : 1.0f);
+	return m;
+}
+
+bool perto(const float *a, const float *b, int n, float tolerancia)
+{
+	for (int k = 0; k < n; k++)
+		if (fabs(a[k] - b[k]) > tolerancia * (1.0f + fabs(b[k])))
+			return false;
+	return true;
+}
+
+int conferir(int pontos)
+{
+	uint32_t x = 99;
+	int erros = 0;
+	for (int k = 0; k < MATRIZES; k++)
+	{
+		mat4 a = sortearMatriz(x), b = sortearMatriz(x);
+		vec4 v(sortearFloat(x), sortearFloat(x), sortearFloat(x), sortearFloat(x));
+		mat4 ab = a * b, abRef = mul_scalar(a, b);
+		vec4 av = a * v, avRef = mul_scalar(a, v);
+		mat4 inv = inverse(a), invRef = inverse_scalar(a);
+		mat4 t = transpose(a), tRef = transpose_scalar(a);
+		mat4 identidade = a * inv, id = identity_mat4();
+		if (!perto(ab.m, abRef.m, 16, 1e-6f) || !perto(av.v, avRef.v, 4, 1e-6f) || !perto(t.m, tRef.m, 16, 0.0f))
+			erros++;
+		if (!perto(inv.m, invRef.m, 16, 1e-5f) || !perto(identidade.m, id.m, 16, 1e-5f))
+			erros++;
+	}
+	printf("conferência mat4 (%d matrizes): %s\n", MATRIZES, erros ? "DIFERENTES" : "ok");
+
+	// Lote: todos os tamanhos de sobra (n não múltiplo de 4 ou 8), com e sem z
+	mat4 m = sortearMatriz(x);
+	vector<float> px(pontos), py(pontos), pz(pontos);
+	for (int i = 0; i < pontos; i++)
+	{
+		px[i] = sortearFloat(x) * 1000.0f;
+		py[i] = sortearFloat(x) * 1000.0f;
+		pz[i] = sortearFloat(x);
+	}
+	int errosLote = 0;
+	vector<float> saida(8 * pontos);
+	float *o = saida.data();
+	for (int n : {0, 1, 3, 7, 9, 17, pontos})
+		for (const float *z : {(const float *)NULL, (const float *)pz.data()})
+		{
+			transform_points_soa(m, px.data(), py.data(), z, o, o + pontos, o + 2 * pontos, o + 3 * pontos, n);
+			transform_points_soa_scalar(m, px.data(), py.data(), z, o + 4 * pontos, o + 5 * pontos, o + 6 * pontos,
+										o + 7 * pontos, n);
+			for (int c = 0; c < 4; c++)
+				if (!perto(o + c * pontos, o + (4 + c) * pontos, n, 1e-6f))
+					errosLote++;
+		}
+	printf("conferência transform_points_soa: %s\n", errosLote ? "DIFERENTES" : "ok");
+	return erros + errosLote;
+}
+
+// Tempo de rep repetições de f, em nanossegundos por repetição (melhor de 3)
+template <class F>
+double medir(int rep, F f)
+{
+	double melhor = 1e30;
+	for (int k = 0; k < 3; k++)
+	{
+		double t0 = agora();
+		f(rep);
+		melhor = min(melhor, agora() - t0);
+	}
+	return melhor * 1e9 / rep;
+}
+
+void linha(const char *nome, double simd, double escalar, double glm)
+{
+	printf("  %-22s %8.2f %8.2f %8.2f   (%.1fx o C++ puro)\n", nome, simd, escalar, glm, escalar / simd);
+}
+
+void medirMat4()
+{
+	uint32_t x = 5;
+	vector<mat4> ms(MATRIZES);
+	vector<glm::mat4> gs(MATRIZES);
+	for (int k = 0; k < MATRIZES; k++)
+	{
+		ms[k] = sortearMatriz(x);
+		for (int c = 0; c < 16; c++)
+			gs[k][c / 4][c % 4] = ms[k].m[c];
+	}
+	mat4 acc = identity_mat4();
+	glm::mat4 gacc(1.0f);
+	float soma = 0.0f;
+	vec4 v(1.0f, 2.0f, 3.0f, 1.0f);
+	glm::vec4 gv(1.0f, 2.0f, 3.0f, 1.0f);
+
+	printf("\nns por operação (%s)      SIMD  C++ puro      GLM\n", maths_simd());
+	// Cada matriz pela seguinte (como projeção * modelo de cada sprite)
+	linha("mat4 * mat4",
+		  medir(MATRIZES - 1, [&](int n) { for (int k = 0; k < n; k++) acc.m[k & 15] += (ms[k] * ms[k + 1]).m[k & 15]; }),
+		  medir(MATRIZES - 1, [&](int n) { for (int k = 0; k < n; k++) acc.m[k & 15] += mul_scalar(ms[k], ms[k + 1]).m[k & 15]; }),
+		  medir(MATRIZES - 1, [&](int n) { for (int k = 0; k < n; k++) gacc[k & 3][0] += (gs[k] * gs[k + 1])[k & 3][0]; }));
+	linha("mat4 * vec4",
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += (ms[k] * v).v[0]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += mul_scalar(ms[k], v).v[0]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += (gs[k] * gv).x; }));
+	linha("inverse",
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += inverse(ms[k]).m[k & 15]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += inverse_scalar(ms[k]).m[k & 15]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += glm::inverse(gs[k])[k & 3][0]; }));
+	linha("transpose",
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += transpose(ms[k]).m[k & 15]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += transpose_scalar(ms[k]).m[k & 15]; }),
+		  medir(MATRIZES, [&](int n) { for (int k = 0; k < n; k++) soma += glm::transpose(gs[k])[k & 3][0]; }));
+	printf("  (soma %g %g %g)\n", soma, acc.m[0], gacc[0][0]);
+}
+
+void medirLote(int pontos)
+{
+	uint32_t x = 11;
+	mat4 m = sortearMatriz(x);
+	glm::mat4 g;
+	for (int c = 0; c < 16; c++)
+		g[c / 4][c % 4] = m.m[c];
+	vector<float> px(pontos), py(pontos), ox(pontos), oy(pontos);
+	vector<glm::vec4> gp(pontos), go(pontos);
+	for (int i = 0; i < pontos; i++)
+	{
+		px[i] = sortearFloat(x) * 1000.0f;
+		py[i] = sortearFloat(x) * 1000.0f;
+		gp[i] = glm::vec4(px[i], py[i], 0.0f, 1.0f);
+	}
+	const int REP = 20;
+	double simd = medir(REP, [&](int n) {
+		for (int k = 0; k < n; k++)
+			transform_points_soa(m, px.data(), py.data(), NULL, ox.data(), oy.data(), NULL, NULL, pontos);
+	});
+	double escalar = medir(REP, [&](int n) {
+		for (int k = 0; k < n; k++)
+			transform_points_soa_scalar(m, px.data(), py.data(), NULL, ox.data(), oy.data(), NULL, NULL, pontos);
+	});
+	double glm = medir(REP, [&](int n) {
+		for (int k = 0; k < n; k++)
+			for (int i = 0; i < pontos; i++)
+				go[i] = g * gp[i];
+	});
+	// Bytes que passam pela memória por ponto: SoA lê x, y e escreve x, y;
+	// a GLM lê e escreve um vec4
+	double bytesSoa = 16.0 * pontos, bytesGlm = 32.0 * pontos;
+	printf("\nlote de %d pontos 2D         SIMD  C++ puro      GLM\n", pontos);
+	linha("ms", simd / 1e6, escalar / 1e6, glm / 1e6);
+	printf("  %-22s %8.1f %8.1f %8.1f\n", "GB/s", bytesSoa / simd, bytesSoa / escalar, bytesGlm / glm);
+	printf("  (soma %g %g)\n", ox[pontos / 2] + oy[pontos / 3], go[pontos / 2].x);
+}
+
+int main(int argc, char **argv)
+{
+	int pontos = 1 << 20;
+	if (argc > 2 || (argc == 2 && (pontos = atoi(argv[1])) <= 0))
+	{
+		fprintf(stderr, "Uso: %s [pontos]\n", argv[0]);
+		return -1;
+	}
+	int erros = conferir(pontos);
+	medirMat4();
+	medirLote(pontos);
+	return erros ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * BenchSelecao - confere e mede a seleção de tiles de TilemapView::getPicker
+ *
+ * Uso:
+ *   BenchSelecao [largura altura]
+ *       para as visões diamond, isométrica e slide, desenha (na CPU) os ids
+ *       dos tiles de um mapa 40x40 numa tela de largura x altura pixels
+ *       (padrão 1280x720), com tiles de tamanho inteiro e quebrado, e confere
+ *       o picker em todos os pixels: dentro de um losango, tem de dar aquele
+ *       tile; na borda entre dois ou mais, um deles; fora do mapa, -1. O canto do
+ *       mapa fica em meio pixel, para que muitos centros de pixel caiam
+ *       exatamente nas bordas.
+ *       Depois mede milhões de seleções por segundo, uma a uma e em lote.
+ *
+ * O desenho de referência não usa o picker: cada losango é preenchido pelo
+ * teste |dx|/(tw/2) + |dy|/(th/2) <= 1 no centro de cada pixel, em double.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "DiamondView.h"
+#include "IsometricView.h"
+#include "SlideView.h"
+
+using namespace std;
+
+#define BORDA 1e-4 // |dx|/(tw/2) + |dy|/(th/2) mais perto de 1 que isso conta como borda
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Pixel
+{
+	int ids[4]; // tiles que cobrem o centro do pixel: 1 por dentro, 2 numa aresta, até 4 num vértice
+	int n;
+	bool borda; // centro em cima da borda de algum losango que o cobre
+};
+
+// Ids de todos os tiles desenhados com o canto do mapa em (x0, y0) da tela.
+// Desenha também uma volta de tiles fora do mapa, com id -1, para que a borda
+// do mapa seja conferida como qualquer outra.
+void desenhar(const TilemapView &view, int cols, int rows, float tw, float th, float x0, float y0,
+			  int largura, int altura, vector<Pixel> &tela)
+{
+	tela.assign((size_t)largura * altura, {{-1, -1, -1, -1}, 0, false});
+	for (int r = -1; r <= rows; r++)
+		for (int c = -1; c <= cols; c++)
+		{
+			bool dentro = r >= 0 && c >= 0 && r < rows && c < cols;
+			float x, y;
+			view.computeDrawPosition(c, r, tw, th, x, y);
+			double cx = x0 + x + tw / 2.0, cy = y0 + y + th / 2.0;
+			int px0 = max(0, (int)floor(cx - tw / 2.0) - 1), px1 = min(largura, (int)ceil(cx + tw / 2.0) + 1);
+			int py0 = max(0, (int)floor(cy - th / 2.0) - 1), py1 = min(altura, (int)ceil(cy + th / 2.0) + 1);
+			for (int py = py0; py < py1; py++)
+				for (int px = px0; px < px1; px++)
+				{
+					double q = fabs(px + 0.5 - cx) / (tw / 2.0) + fabs(py + 0.5 - cy) / (th / 2.0);
+					if (q > 1.0 + BORDA)
+						continue;
+					Pixel &p = tela[(size_t)py * largura + px];
+					if (p.n < 4)
+						p.ids[p.n++] = dentro ? r * cols + c : -1;
+					p.borda = p.borda || q >= 1.0 - BORDA;
+				}
+		}
+}
+
+// Erros do picker contra o desenho, em todos os pixels
+int conferir(const TilePicker &picker, float x0, float y0, int largura, int altura, const vector<Pixel> &tela,
+			 int &bordas)
+{
+	int erros = 0;
+	bordas = 0;
+	for (int py = 0; py < altura; py++)
+		for (int px = 0; px < largura; px++)
+		{
+			const Pixel &p = tela[(size_t)py * largura + px];
+			int col, row;
+			int id = picker.pick(px + 0.5f - x0, py + 0.5f - y0, col, row) ? row * picker.cols + col : -1;
+			if (p.borda)
+			{
+				// entre tiles: qualquer um deles
+				bordas++;
+				bool algum = false;
+				for (int k = 0; k < p.n; k++)
+					algum = algum || id == p.ids[k];
+				if (!algum)
+					erros++;
+			}
+			else if (id != p.ids[0])
+				erros++;
+		}
+	return erros;
+}
+
+int main(int argc, char **argv)
+{
+	int largura = 1280, altura = 720;
+	if (argc == 3)
+	{
+		largura = atoi(argv[1]);
+		altura = atoi(argv[2]);
+	}
+	if (argc != 1 && (argc != 3 || largura <= 0 || altura <= 0))
+	{
+		fprintf(stderr, "Uso: %s [largura altura]\n", argv[0]);
+		return -1;
+	}
+
+	DiamondView diamond;
+	IsometricView isometrica;
+	SlideView slide;
+	struct
+	{
+		const char *nome;
+		const TilemapView *view;
+		float x0, y0; // canto do mapa na tela
+	} visoes[] = {
+		{"diamond", &diamond, -100.5f, 300.0f},
+		{"isometrica", &isometrica, 600.5f, -50.0f},
+		{"slide", &slide, -300.5f, -20.0f},
+	};
+	float tamanhos[][2] = {{64.0f, 32.0f}, {37.3f, 18.65f}, {50.0f, 29.0f}};
+	const int N = 40;
+
+	int retorno = 0;
+	vector<Pixel> tela;
+	for (auto &v : visoes)
+	{
+		for (auto &t : tamanhos)
+		{
+			desenhar(*v.view, N, N, t[0], t[1], v.x0, v.y0, largura, altura, tela);
+			TilePicker picker = v.view->getPicker(t[0], t[1], N, N);
+			int bordas;
+			int erros = conferir(picker, v.x0, v.y0, largura, altura, tela, bordas);
+			printf("%-10s tiles %5.2fx%-5.2f  %d pixels (%d na borda): %s\n", v.nome, t[0], t[1], largura * altura,
+				   bordas, erros ? "ERRADO" : "ok");
+			if (erros)
+			{
+				printf("           %d pixels com o tile errado\n", erros);
+				retorno = 1;
+			}
+		}
+	}
+
+	// Velocidade: pontos aleatórios na tela, um a um e em lote
+	const int PONTOS = 1 << 20;
+	vector<float> xy(2 * PONTOS);
+	uint32_t x = 1;
+	for (float &f : xy)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		f = (x % 100000) / 100.0f;
+	}
+	vector<int> tiles(PONTOS);
+	TilePicker picker = isometrica.getPicker(64.0f, 32.0f, N, N);
+	long long soma = 0;
+	double t0 = agora();
+	for (int rep = 0; rep < 10; rep++)
+		for (int k = 0; k < PONTOS; k++)
+		{
+			int col, row;
+			if (picker.pick(xy[2 * k], xy[2 * k + 1], col, row))
+				soma += row * N + col;
+		}
+	double tUm = agora() - t0;
+	t0 = agora();
+	for (int rep = 0; rep < 10; rep++)
+	{
+		picker.pick(xy.data(), PONTOS, tiles.data());
+		soma += tiles[rep];
+	}
+	double tLote = agora() - t0;
+	printf("\nseleção: %.1f milhões/s um a um, %.1f milhões/s em lote (soma %lld)\n", 10.0 * PONTOS / tUm / 1e6,
+		   10.0 * PONTOS / tLote / 1e6, soma);
+	return retorno;
+}
@@ -0,0 +1,245 @@
+/*
+ * ConverteMapa - gera mapas binários .tbin (ver common/M5-6/BinaryMap.h)
+ *
+ * Uso:
+ *   ConverteMapa <entrada> <saida.tbin> [tileProps.txt]
+ *       entrada: .txt do Trabfinal (config/tileMap.txt), .tmap (exemplo_07)
+ *       ou .tmx do Tiled (primeira camada). As propriedades dos tiles vêm do
+ *       tileProps.txt, se dado; senão ficam todas "desconhecidas".
+ *
+ *   ConverteMapa --bench [N...]
+ *       mede o tempo de carga de mapas NxN aleatórios no formato .txt
+ *       (loadMapConfig) e .tbin (loadMapBinary). Padrão: 1024 4096 16384.
+ *       Os arquivos temporários são criados na pasta atual e apagados no fim.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Modulo6/MapConfig.h"
+#include "TmxImporter.h"
+
+using namespace std;
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+string extensao(const string &path)
+{
+	size_t p = path.rfind('.');
+	return p == string::npos ? "" : path.substr(p);
+}
+
+// .tmap: "w h" e depois h linhas de w ids (primeira linha do arquivo = linha 0 do .tbin)
+bool lerTmap(const string &path, MapConfig &cfg, string &err)
+{
+	ifstream arq(path);
+	if (!arq || !(arq >> cfg.cols >> cfg.rows) || cfg.cols <= 0 || cfg.rows <= 0)
+	{
+		err = "Cabeçalho inválido em " + path;
+		return false;
+	}
+	cfg.matrixTexto.resize((size_t)cfg.cols * cfg.rows);
+	int maxId = 0;
+	for (size_t i = 0; i < cfg.matrixTexto.size(); i++)
+	{
+		int tid;
+		if (!(arq >> tid) || tid < 0 || tid > 255)
+		{
+			err = "Id inválido ou faltando em " + path;
+			return false;
+		}
+		cfg.matrixTexto[i] = (unsigned char)tid;
+		maxId = max(maxId, tid);
+	}
+	cfg.matrix = cfg.matrixTexto.data();
+	cfg.nTiles = maxId + 1;
+	cfg.tileW = cfg.tileH = 0;
+	cfg.playerInicialRow = cfg.playerInicialCol = 0;
+	cfg.tilesetFile = "";
+	return true;
+}
+
+// .tmx do Tiled (ver common/M5-6/TmxImporter.h): só a primeira camada, em
+// qualquer codificação; mapas infinitos viram o retângulo que cobre os chunks.
+// O id no .tbin é o gid - 1 (como nos .tmap convertidos à mão); o .tbin não
+// tem tile vazio, então gid 0 ou tiles faltando são erro.
+bool lerTmx(const string &path, MapConfig &cfg, string &err)
+{
+	vector<TmxTileLayer> camadas;
+	TmxMapInfo info;
+	if (!TmxImporter::loadTileMaps(path, camadas, info, err, false, 0, false))
+		return false;
+	if (camadas.empty())
+	{
+		err = path + ": nenhuma camada de tiles";
+		return false;
+	}
+
+	TileMap *tm = camadas[0].tiles;
+	cfg.cols = tm->getWidth();
+	cfg.rows = tm->getHeight();
+	cfg.tileW = info.tileW;
+	cfg.tileH = info.tileH;
+	cfg.tilesetFile = info.tilesets.empty() ? "" : info.tilesets[0].second;
+	cfg.matrixTexto.assign(tm->getMap(), tm->getMap() + (size_t)cfg.cols * cfg.rows);
+	for (size_t i = 0; i < camadas.size(); i++)
+		delete camadas[i].tiles;
+	if (info.infinite)
+		cout << path << ": mapa infinito, origem em (" << camadas[0].originX << ", " << camadas[0].originY << ")" << endl;
+
+	cfg.matrix = cfg.matrixTexto.data();
+	cfg.nTiles = *max_element(cfg.matrixTexto.begin(), cfg.matrixTexto.end()) + 1;
+	cfg.playerInicialRow = cfg.playerInicialCol = 0;
+	return true;
+}
+
+int converter(const string &entrada, const string &saida, const string &props)
+{
+	MapConfig cfg;
+	vector<TileType> tileTypes;
+	string err, ext = extensao(entrada);
+
+	bool ok;
+	if (ext == ".txt")
+		ok = loadMapConfig(entrada, cfg, err);
+	else if (ext == ".tmap")
+		ok = lerTmap(entrada, cfg, err);
+	else if (ext == ".tmx")
+		ok = lerTmx(entrada, cfg, err);
+	else
+	{
+		err = "Formato não reconhecido: " + entrada;
+		ok = false;
+	}
+	if (!ok)
+	{
+		cerr << "Erro: " << err << endl;
+		return -1;
+	}
+
+	tileTypes.assign(cfg.nTiles, TileType::Unknown);
+	if (!props.empty() && !loadTileProps(props, tileTypes, err))
+	{
+		cerr << "Erro: " << err << endl;
+		return -1;
+	}
+
+	if (!saveMapBinary(saida, cfg, tileTypes, err))
+	{
+		cerr << "Erro: " << err << endl;
+		return -1;
+	}
+	cout << entrada << " -> " << saida << " (" << cfg.cols << "x" << cfg.rows << ", "
+		 << cfg.nTiles << " tiles)" << endl;
+	return 0;
+}
+
+// Mapa NxN aleatório no formato do config/tileMap.txt
+bool gerarTexto(const string &path, int n)
+{
+	FILE *out = fopen(path.c_str(), "wb");
+	if (!out)
+		return false;
+	fprintf(out, "[file]\ntilesetIso.png\n\n[nTiles]\n7\n\n[width]\n114\n\n[height]\n57\n\n"
+				 "[rows]\n%d\n\n[columns]\n%d\n\n[rowInicialPosition]\n0\n\n[columnInicialPosition]\n0\n\n[matrix]\n",
+			n, n);
+	vector<char> linha(2 * n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			linha[2 * j] = '0' + rand() % 7;
+			linha[2 * j + 1] = ' ';
+		}
+		linha[2 * n - 1] = '\n';
+		fwrite(linha.data(), 1, linha.size(), out);
+	}
+	return fclose(out) == 0;
+}
+
+int benchmark(const vector<int> &tamanhos)
+{
+	cout << "      N |  .txt (MB) | loadMapConfig (s) |   (MB/s) | .tbin (MB) | loadMapBinary (s) | + ler todos (s)" << endl;
+	for (int n : tamanhos)
+	{
+		string txt = "bench_mapa_" + to_string(n) + ".txt";
+		string bin = "bench_mapa_" + to_string(n) + ".tbin";
+		if (!gerarTexto(txt, n))
+		{
+			cerr << "Não foi possível criar " << txt << endl;
+			return -1;
+		}
+
+		string err;
+		double t0 = agora();
+		MapConfig cfg;
+		bool ok = loadMapConfig(txt, cfg, err);
+		double tTexto = agora() - t0;
+		vector<TileType> tileTypes(cfg.nTiles, TileType::Walkable);
+		ok = ok && saveMapBinary(bin, cfg, tileTypes, err);
+		cfg.matrixTexto.clear();
+		cfg.matrixTexto.shrink_to_fit();
+		if (!ok)
+		{
+			cerr << "Erro: " << err << endl;
+			remove(txt.c_str());
+			return -1;
+		}
+
+		// mesmo processo, segunda leitura: o .tbin acabou de ser gravado e
+		// está no cache do SO, como o .txt também estava
+		MapConfig cfgBin;
+		t0 = agora();
+		ok = loadMapBinary(bin, cfgBin, tileTypes, err);
+		double tBinario = agora() - t0;
+		unsigned long long soma = 0;
+		size_t total = (size_t)n * n;
+		for (size_t i = 0; ok && i < total; i++)
+			soma += cfgBin.matrix[i];
+		double tLeitura = agora() - t0;
+
+		double mbTexto = (double)filesystem::file_size(txt) / (1 << 20);
+		double mbBinario = (double)filesystem::file_size(bin) / (1 << 20);
+		cfgBin.binario.close();
+		remove(txt.c_str());
+		remove(bin.c_str());
+		if (!ok)
+		{
+			cerr << "Erro: " << err << endl;
+			return -1;
+		}
+
+		printf("%7d | %10.1f | %17.4f | %8.0f | %10.1f | %17.6f | %15.4f   (soma %llu)\n",
+			   n, mbTexto, tTexto, mbTexto / tTexto, mbBinario, tBinario, tLeitura, soma);
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc >= 2 && string(argv[1]) == "--bench")
+	{
+		vector<int> tamanhos;
+		for (int i = 2; i < argc; i++)
+			tamanhos.push_back(atoi(argv[i]));
+		if (tamanhos.empty())
+			tamanhos = {1024, 4096, 16384};
+		return benchmark(tamanhos);
+	}
+
+	if (argc < 3 || argc > 4)
+	{
+		cerr << "Uso: " << argv[0] << " <entrada.txt|.tmap|.tmx> <saida.tbin> [tileProps.txt]" << endl;
+		cerr << "     " << argv[0] << " --bench [N...]" << endl;
+		return -1;
+	}
+	return converter(argv[1], argv[2], argc == 4 ? argv[3] : "");
+}
@@ -0,0 +1,89 @@
+/*
+ * GeraAtlas - empacota PNGs em um atlas de textura (ver common/M5-6/TextureAtlas.h)
+ *
+ * Uso:
+ *   GeraAtlas                          -> todos os PNGs de ../assets/sprites e
+ *                                         ../assets/tilesets, gravados em ../assets/atlas
+ *   GeraAtlas <saida> <pasta|png>...   -> as pastas/arquivos dados, gravados em <saida>
+ *
+ * Gera <saida>_0.png (e _1, _2... se não couber em uma página) e <saida>.txt,
+ * que TextureAtlas::load() lê na inicialização do jogo. O nome de cada imagem
+ * no atlas é o nome do arquivo sem extensão (ex.: "coin").
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "TextureAtlas.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Junta os PNGs de uma pasta (em ordem alfabética) ou o próprio arquivo
+void coletar(const fs::path &caminho, vector<fs::path> &pngs)
+{
+	if (fs::is_directory(caminho))
+	{
+		vector<fs::path> daPasta;
+		for (const auto &entrada : fs::directory_iterator(caminho))
+			if (entrada.path().extension() == ".png")
+				daPasta.push_back(entrada.path());
+		sort(daPasta.begin(), daPasta.end());
+		pngs.insert(pngs.end(), daPasta.begin(), daPasta.end());
+	}
+	else
+		pngs.push_back(caminho);
+}
+
+int main(int argc, char **argv)
+{
+	string saida = "../assets/atlas";
+	vector<fs::path> pngs;
+
+	if (argc >= 3)
+	{
+		saida = argv[1];
+		for (int i = 2; i < argc; i++)
+			coletar(argv[i], pngs);
+	}
+	else if (argc == 1)
+	{
+		coletar("../assets/sprites", pngs);
+		coletar("../assets/tilesets", pngs);
+	}
+	else
+	{
+		cerr << "Uso: " << argv[0] << " [<saida> <pasta|png>...]" << endl;
+		return -1;
+	}
+
+	TextureAtlas atlas;
+	set<string> nomes;
+	for (const fs::path &png : pngs)
+	{
+		if (!nomes.insert(png.stem().string()).second)
+			cerr << "Aviso: nome repetido " << png.stem() << ", fica a última imagem" << endl;
+		if (!atlas.add(png.stem().string(), png.string()))
+			return -1;
+	}
+
+	if (!atlas.pack() || !atlas.save(saida))
+	{
+		cerr << "Falha ao gerar o atlas " << saida << endl;
+		return -1;
+	}
+
+	cout << pngs.size() << " imagens em " << atlas.getPageCount() << " página(s): " << saida << ".txt" << endl;
+	return 0;
+}
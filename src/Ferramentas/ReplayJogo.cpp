@@ -0,0 +1,174 @@
+/*
+ * ReplayJogo - roda partidas do Trabfinal sem janela nem OpenGL (ver src/Modulo6/Jogo.h)
+ *
+ * Uso:
+ *   ReplayJogo <gravacao.txt> [repeticoes] [threads]
+ *       reproduz uma gravação feita com "Trabfinal --gravar gravacao.txt",
+ *       mostra o estado final e confere que todas as repetições terminam
+ *       iguais. Padrão: 100000 repetições, 1 thread.
+ *
+ *   ReplayJogo --aleatorio <passos> [threads] [--moedas N]
+ *       comandos aleatórios (sempre os mesmos); ao fim de cada partida o jogo
+ *       recomeça com outra semente. Mede passos por segundo. --moedas muda o
+ *       máximo de moedas sorteadas (padrão 15), para testar mapas cheios.
+ *
+ * Cada thread tem a sua cópia do jogo; o mapa é lido uma vez e compartilhado.
+ * Rode de dentro de build/, como o Trabfinal (usa ../src/Modulo6/config).
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Modulo6/Jogo.h"
+
+using namespace std;
+
+struct Resultado
+{
+	uint64_t passos = 0;  // comandos aplicados
+	uint64_t hash = 0;	  // estado ao fim da primeira repetição
+	bool iguais = true;	  // todas as repetições acabaram no mesmo estado
+};
+
+double agora()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void reproduzir(Jogo jogo, uint32_t semente, const vector<Comando> &comandos, int repeticoes, Resultado &r)
+{
+	for (int k = 0; k < repeticoes; k++)
+	{
+		jogo.reiniciar(semente);
+		for (Comando c : comandos)
+			jogo.passo(c);
+		r.passos += jogo.estado().passos;
+		if (k == 0)
+			r.hash = jogo.hash();
+		else if (jogo.hash() != r.hash)
+			r.iguais = false;
+	}
+}
+
+void aleatorio(Jogo jogo, const vector<Comando> &comandos, int thread, Resultado &r)
+{
+	uint32_t semente = 1000u * thread + 1;
+	jogo.reiniciar(semente);
+	for (Comando c : comandos)
+	{
+		jogo.passo(c);
+		if (jogo.estado().fim)
+			jogo.reiniciar(++semente);
+	}
+	r.passos = comandos.size();
+	r.hash = jogo.hash();
+}
+
+int main(int argc, char **argv)
+{
+	int maxMoedas = Jogo::MAX_MOEDAS;
+	vector<char *> args;
+	for (int i = 0; i < argc; i++)
+	{
+		if (string(argv[i]) == "--moedas" && i + 1 < argc)
+			maxMoedas = atoi(argv[++i]);
+		else
+			args.push_back(argv[i]);
+	}
+	argc = (int)args.size();
+	argv = args.data();
+
+	if (argc < 2 || argc > 4 || (string(argv[1]) == "--aleatorio" && argc < 3))
+	{
+		cerr << "Uso: " << argv[0] << " <gravacao.txt> [repeticoes] [threads]" << endl;
+		cerr << "     " << argv[0] << " --aleatorio <passos> [threads] [--moedas N]" << endl;
+		return -1;
+	}
+
+	MapConfig cfg;
+	vector<TileType> tileTypes;
+	string err;
+	if (!loadMap("../src/Modulo6/config/tileMap.txt", "../src/Modulo6/config/tileProps.txt",
+				 "../src/Modulo6/config/tileMap.tbin", cfg, tileTypes, err))
+	{
+		cerr << "Erro: " << err << endl;
+		return -1;
+	}
+	bool modoAleatorio = string(argv[1]) == "--aleatorio";
+	uint32_t semente = 0;
+	vector<Comando> comandos;
+	int repeticoes = 1;
+	if (modoAleatorio)
+	{
+		long n = atol(argv[2]);
+		uint32_t x = 12345;
+		for (long k = 0; k < n; k++)
+		{
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			comandos.push_back((Comando)(1 + x % 8));
+		}
+	}
+	else
+	{
+		if (!lerGravacao(argv[1], semente, maxMoedas, comandos, err))
+		{
+			cerr << "Erro: " << err << endl;
+			return -1;
+		}
+		repeticoes = argc >= 3 ? atoi(argv[2]) : 100000;
+	}
+	int nThreads = argc >= 4 ? atoi(argv[3]) : 1;
+	if (nThreads < 1 || repeticoes < 1)
+	{
+		cerr << "Repetições e threads devem ser pelo menos 1" << endl;
+		return -1;
+	}
+
+	Jogo jogo(cfg, tileTypes, maxMoedas);
+
+	vector<Resultado> resultados(nThreads);
+	vector<thread> threads;
+	double t0 = agora();
+	for (int t = 0; t < nThreads; t++)
+	{
+		if (modoAleatorio)
+			threads.push_back(thread(aleatorio, jogo, cref(comandos), t, ref(resultados[t])));
+		else
+			threads.push_back(thread(reproduzir, jogo, semente, cref(comandos), repeticoes, ref(resultados[t])));
+	}
+	for (thread &t : threads)
+		t.join();
+	double tempo = agora() - t0;
+
+	uint64_t passos = 0;
+	bool iguais = true;
+	for (const Resultado &r : resultados)
+	{
+		passos += r.passos;
+		iguais = iguais && r.iguais && (modoAleatorio || r.hash == resultados[0].hash);
+	}
+
+	if (!modoAleatorio)
+	{
+		// Estado final de uma repetição, para conferir com a partida gravada
+		jogo.reiniciar(semente);
+		for (Comando c : comandos)
+			jogo.passo(c);
+		const EstadoJogo &e = jogo.estado();
+		printf("%s: %zu comandos, semente %u\n", argv[1], comandos.size(), semente);
+		printf("  fim: %s  vida %d  moedas %d/%d  posição (%d, %d)  passos aplicados %llu\n",
+			   !e.fim ? "não" : (e.vida <= 0 ? "perdeu" : "venceu"), e.vida, e.pontuacao, e.totalMoedas,
+			   e.player_i, e.player_j, (unsigned long long)e.passos);
+		printf("  estado %016llx, repetições iguais: %s\n", (unsigned long long)resultados[0].hash, iguais ? "sim" : "NÃO");
+	}
+	printf("%llu passos em %.3f s com %d thread(s): %.2f milhões de passos/s\n",
+		   (unsigned long long)passos, tempo, nThreads, passos / tempo / 1e6);
+	return iguais ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <assert.h>
+#include <cstdlib>
 #include <vector>
 
 using namespace std;
@@ -17,6 +18,8 @@ using namespace glm;
 
 #include <cmath>
 
+#include "TriangleStore.h"
+
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
@@ -28,23 +31,25 @@ const GLuint WIDTH = 800, HEIGHT = 600;
 
 const GLchar *vertexShaderSource = R"(
 #version 400
-layout (location = 0) in vec3 position;
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec3 vertexColor;
 uniform mat4 projection;
-uniform mat4 model;
+out vec3 finalColor;
 void main()	
 {
 	//...pode ter mais linhas de código aqui!
-	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+	gl_Position = projection * vec4(position.x, position.y, 0.0, 1.0);
+	finalColor = vertexColor;
 }
 )";
 
 const GLchar *fragmentShaderSource = R"(
 #version 400
-uniform vec4 inputColor;
+in vec3 finalColor;
 out vec4 color;
 void main()
 {
-	color = inputColor;
+	color = vec4(finalColor, 1.0);
 }
 )";
 
@@ -55,7 +60,9 @@ struct Triangle {
     vec3 color;
 };
 
-vector<Triangle> triangles;
+// Todos os triângulos ficam na GPU, num buffer só; cada clique acrescenta um
+TriangleStore *triangles = NULL;
+void addTriangle(const Triangle &tri);
 
 vector <vec3> colors;
 int iColor = 0;
@@ -104,24 +111,12 @@ int main()
 	glViewport(0, 0, width, height);
 
 	GLuint shaderID = setupShader();
-	
-	GLuint VAO = createTriangle(-0.5,-0.5,0.5,-0.5,0.0,0.5);
-	
-	if (vertices.size() == 3)
-	{
-		Triangle tri;
-		tri.v1 = vertices[0];
-		tri.v2 = vertices[1];
-		tri.v3 = vertices[2];
-		tri.color = vec3(colors[iColor].r, colors[iColor].g, colors[iColor].b);
-		iColor = (iColor + 1) % colors.size();
-		triangles.push_back(tri);
-		vertices.clear();
-	}
 
-	glUseProgram(shaderID);
+	triangles = new TriangleStore();
+	triangles->init();
+	cout << "Triângulos em buffer " << (triangles->isPersistent() ? "mapeado persistente" : "com glBufferSubData") << endl;
 
-	GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
+	glUseProgram(shaderID);
 
 	mat4 projection = ortho(0.0, 800.0, 600.0, 0.0, -1.0, 1.0);
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
@@ -136,37 +131,12 @@ int main()
 		glLineWidth(10);
 		glPointSize(20);
 
-		glBindVertexArray(VAO);
-
-		for (int i = 0; i < triangles.size(); i++)
-		{
-			vec3 vertices[3] = {
-				triangles[i].v1,
-				triangles[i].v2,
-				triangles[i].v3
-			};
-
-			GLuint tempVBO;
-			glGenBuffers(1, &tempVBO);
-			glBindBuffer(GL_ARRAY_BUFFER, tempVBO);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-			glUniform4f(colorLoc, triangles[i].color.r, triangles[i].color.g, triangles[i].color.b, 1.0f);
-
-			mat4 model = mat4(1);
-			glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-
-			glDrawArrays(GL_TRIANGLES, 0, 3);
-			glDeleteBuffers(1, &tempVBO);
-		}
-
-		glBindVertexArray(0);
+		// Um draw para todos os triângulos
+		triangles->draw();
 
 		glfwSwapBuffers(window);
 	}
+	delete triangles;
 	glfwTerminate();
 	return 0;
 }
@@ -175,6 +145,40 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	// Teste de carga: R acrescenta 10000 triângulos sorteados
+	if (key == GLFW_KEY_R && action == GLFW_PRESS)
+	{
+		for (int i = 0; i < 10000; i++)
+		{
+			vec3 centro = vec3(rand() % WIDTH, rand() % HEIGHT, 0.0);
+			Triangle tri;
+			tri.v1 = centro + vec3(rand() % 21 - 10, rand() % 21 - 10, 0.0);
+			tri.v2 = centro + vec3(rand() % 21 - 10, rand() % 21 - 10, 0.0);
+			tri.v3 = centro + vec3(rand() % 21 - 10, rand() % 21 - 10, 0.0);
+			tri.color = colors[iColor];
+			iColor = (iColor + 1) % colors.size();
+			addTriangle(tri);
+		}
+		char titulo[64];
+		sprintf(titulo, "Ola Triangulo! -- %d triangulos", (int)triangles->getTriangles());
+		glfwSetWindowTitle(window, titulo);
+	}
+}
+
+void addTriangle(const Triangle &tri)
+{
+	vec3 v[3] = {tri.v1, tri.v2, tri.v3};
+	ColorVertex cv[3];
+	for (int i = 0; i < 3; i++)
+	{
+		cv[i].x = v[i].x;
+		cv[i].y = v[i].y;
+		cv[i].r = tri.color.r;
+		cv[i].g = tri.color.g;
+		cv[i].b = tri.color.b;
+	}
+	triangles->add(cv[0], cv[1], cv[2]);
 }
 
 int setupShader()
@@ -299,7 +303,7 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             tri.color = vec3(colors[iColor].r, colors[iColor].g, colors[iColor].b);
             iColor = (iColor + 1) % colors.size();
 
-            triangles.push_back(tri);
+            addTriangle(tri);
 
             // Limpa para começar a capturar os próximos 3 cliques
             vertices.clear();
@@ -5,6 +5,8 @@
 using namespace std;
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "ColorGrid.h"
+#include "ColorIndex.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -16,42 +18,18 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
 bool verificarFimDoJogo();
 
-GLuint createQuad();
-int setupShader();
 int setupGeometry();
 void eliminarSimilares(float tolerancia);
+void montarIndice();
+void eliminar(int i, int j);
 
 const GLuint WIDTH = 800, HEIGHT = 600;
 const GLuint ROWS = 6, COLS = 8;
 const GLuint QUAD_WIDTH = 100, QUAD_HEIGHT = 100;
 const float dMax = sqrt(3.0);
 
-const GLchar *vertexShaderSource = R"(
-#version 400
-layout (location = 0) in vec3 position;
-uniform mat4 projection;
-uniform mat4 model;
-void main()	
-{
-	//...pode ter mais linhas de código aqui!
-	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-}
-)";
-
-const GLchar *fragmentShaderSource = R"(
-#version 400
-uniform vec4 inputColor;
-out vec4 color;
-void main()
-{
-	color = inputColor;
-}
-)";
-
 struct Quad
 {
-	vec3 position;
-	vec3 dimensions;
 	vec3 color;
 	bool eliminated;
 };
@@ -68,6 +46,16 @@ bool jogoEncerrado = false;
 
 Quad grid[ROWS][COLS];
 
+// Cores dos quadrados ainda no jogo (id = i * COLS + j), para achar as
+// parecidas sem varrer a grade, e quantos ainda faltam eliminar
+const float TOLERANCIA = 0.2;
+ColorIndex indice(TOLERANCIA * dMax);
+vector<int> similares;
+int vivos = 0;
+
+// A grade inteira na GPU (cor e eliminado por quadrado), desenhada numa chamada
+ColorGrid *quadros;
+
 int main()
 {
 	srand(time(0));
@@ -94,18 +82,14 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	GLuint shaderID = setupShader();
-
-	GLuint VAO = createQuad();
+	quadros = new ColorGrid();
+	quadros->init(ROWS, COLS, QUAD_WIDTH, QUAD_HEIGHT);
 
 	for (int i = 0; i < ROWS; i++)
 	{
 		for (int j = 0; j < COLS; j++)
 		{
 			Quad quad;
-			vec2 ini_pos = vec2(QUAD_WIDTH / 2, QUAD_HEIGHT / 2);
-			quad.position = vec3(ini_pos.x + j * QUAD_WIDTH, ini_pos.y + i * QUAD_HEIGHT, 0.0);
-			quad.dimensions = vec3(QUAD_WIDTH, QUAD_HEIGHT, 1.0);
 			float r, g, b;
 			r = rand() % 256 / 255.0;
 			g = rand() % 256 / 255.0;
@@ -115,13 +99,9 @@ int main()
 			grid[i][j] = quad;
 		}
 	}
-
-	glUseProgram(shaderID);
-
-	GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
+	montarIndice();
 
 	mat4 projection = ortho(0.0, 800.0, 600.0, 0.0, -1.0, 1.0);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
 
 	while (!glfwWindowShouldClose(window))
 	{
@@ -130,33 +110,13 @@ int main()
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		glLineWidth(10);
-		glPointSize(20);
-
-		glBindVertexArray(VAO);
-
 		if (iSelected > -1)
 		{
-			eliminarSimilares(0.2);
+			eliminarSimilares(TOLERANCIA);
 		}
 
-
-		for (int i = 0; i < ROWS; i++)
-		{
-			for (int j = 0; j < COLS; j++)
-			{
-				if (!grid[i][j].eliminated)
-				{
-					mat4 model = mat4(1);
-					model = translate(model, grid[i][j].position);
-					model = scale(model, grid[i][j].dimensions);
-					glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-					glUniform4f(colorLoc, grid[i][j].color.r, grid[i][j].color.g, grid[i][j].color.b, 1.0f); // enviando cor para variável uniform inputColor
-
-					glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
-				}
-			}
-		}
+		// Só os quadrados que mudaram desde o último quadro são enviados
+		quadros->draw(value_ptr(projection));
 
 		if (!jogoEncerrado && verificarFimDoJogo())
 		{
@@ -164,11 +124,10 @@ int main()
 			std::cout << "Pontos finais: " << pontos-(tentativas*10) << std::endl;
 		}
 
-		glBindVertexArray(0);
-
 		glfwSwapBuffers(window);
 	}
 
+	delete quadros;
 	glfwTerminate();
 	return 0;
 }
@@ -186,58 +145,16 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 		for (int i = 0; i < ROWS; i++) {
 			for (int j = 0; j < COLS; j++) {
-				grid[i][j].position = vec3(j * QUAD_WIDTH + QUAD_WIDTH / 2.0f, i * QUAD_HEIGHT + QUAD_HEIGHT / 2.0f, 0.0f);
-				grid[i][j].dimensions = vec3(QUAD_WIDTH, QUAD_HEIGHT, 1.0f);
 				grid[i][j].color = vec3(static_cast<float>(rand()) / RAND_MAX,
 										static_cast<float>(rand()) / RAND_MAX,
 										static_cast<float>(rand()) / RAND_MAX);
 				grid[i][j].eliminated = false;
 			}
 		}
+		montarIndice();
 	}
 }
 
-int setupShader()
-{
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
 	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
@@ -248,83 +165,62 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 		cout << xpos / QUAD_WIDTH << " " << ypos / QUAD_HEIGHT << endl;
 		int x = xpos / QUAD_WIDTH;
 		int y = ypos / QUAD_HEIGHT;
-		if (grid[y][x].eliminated == false)
-				{
-					pontos = pontos+10;
-				}
-		grid[y][x].eliminated = true;
+		if (x < 0 || y < 0 || x >= COLS || y >= ROWS)
+			return;
+		eliminar(y, x);
 		iSelected = x + y * COLS;
 
 		tentativas++;
 	}
 }
 
-GLuint createQuad()
-{
-	GLuint VAO;
-
-	GLfloat vertices[] = {
-		-0.5, 0.5, 0.0,
-		-0.5, -0.5, 0.0,
-		0.5, 0.5, 0.0,
-		0.5, -0.5, 0.0
-	};
-
-	GLuint VBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glGenVertexArrays(1, &VAO);
-
-	glBindVertexArray(VAO);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid *)0);
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	glBindVertexArray(0);
-
-	return VAO;
-}
-
 void eliminarSimilares(float tolerancia)
 {
 	int x = iSelected % COLS;
 	int y = iSelected / COLS;
 	vec3 C = grid[y][x].color;
-	grid[y][x].eliminated = true;
-	for (int i = 0; i < ROWS; i++)
+	eliminar(y, x);
+	// d / dMax <= tolerancia; o índice só devolve quadrados ainda não eliminados
+	similares.clear();
+	indice.removeWithin(C.r, C.g, C.b, tolerancia * dMax, similares);
+	for (int k = 0; k < similares.size(); k++)
 	{
-		for (int j=0; j < COLS; j++)
-		{
-			vec3 O = grid[i][j].color;
-			float d = sqrt(pow(C.r-O.r,2) + pow(C.g-O.g,2) + pow(C.b-O.b,2));
-			float dd = d/dMax;
-			if (dd <= tolerancia)
-			{
-				if (grid[i][j].eliminated == false)
-				{
-					pontos = pontos+10;
-				}
-				grid[i][j].eliminated = true;
-			}
-
-		}
+		int i = similares[k] / COLS, j = similares[k] % COLS;
+		grid[i][j].eliminated = true;
+		quadros->eliminate(similares[k]);
+		pontos = pontos + 10;
+		vivos--;
 	}
 	iSelected = -1;
 }
 
+// Conta mantida a cada eliminação, sem varrer a grade
 bool verificarFimDoJogo()
 {
+	return vivos == 0;
+}
+
+void montarIndice()
+{
+	indice.clear();
 	for (int i = 0; i < ROWS; i++)
 	{
 		for (int j = 0; j < COLS; j++)
 		{
-			if (!grid[i][j].eliminated)
-				return false;
+			indice.insert(i * COLS + j, grid[i][j].color.r, grid[i][j].color.g, grid[i][j].color.b);
+			quadros->setColor(i * COLS + j, grid[i][j].color.r, grid[i][j].color.g, grid[i][j].color.b);
 		}
 	}
-	return true;
+	vivos = ROWS * COLS;
+}
+
+void eliminar(int i, int j)
+{
+	if (grid[i][j].eliminated)
+		return;
+	grid[i][j].eliminated = true;
+	indice.remove(i * COLS + j);
+	quadros->eliminate(i * COLS + j);
+	pontos = pontos + 10;
+	vivos--;
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "SpriteBatch.h"
+
 const GLint WIDTH = 800, HEIGHT = 600;
 
 struct Quad {
@@ -17,38 +19,30 @@ struct Quad {
 };
 
 struct Sprite {
-    GLuint vao;
     GLuint texture;
-    GLuint shader;
     Quad quad;
     glm::vec2 uv_min = {0.0f, 0.0f};
     glm::vec2 uv_max = {1.0f, 1.0f};
 
-    Sprite(GLuint vao, GLuint texture, GLuint shader, const Quad& quad)
-        : vao(vao), texture(texture), shader(shader), quad(quad) {}
-
-    Sprite(GLuint vao, GLuint texture, GLuint shader, Quad quad, glm::vec2 uv_min, glm::vec2 uv_max)
-        : vao(vao), texture(texture), shader(shader), quad(quad), uv_min(uv_min), uv_max(uv_max) {}
-
-    void draw(glm::mat4 proj) {
-        glUseProgram(shader);
+    Sprite(GLuint texture, const Quad& quad)
+        : texture(texture), quad(quad) {}
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(quad.position, 0.0f));
-        model = glm::scale(model, glm::vec3(quad.dimensions, 1.0f));
+    Sprite(GLuint texture, Quad quad, glm::vec2 uv_min, glm::vec2 uv_max)
+        : texture(texture), quad(quad), uv_min(uv_min), uv_max(uv_max) {}
 
-        glUniformMatrix4fv(glGetUniformLocation(shader, "proj"), 1, GL_FALSE, glm::value_ptr(proj));
-        glUniformMatrix4fv(glGetUniformLocation(shader, "matrix"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniform2fv(glGetUniformLocation(shader, "uv_min"), 1, glm::value_ptr(uv_min));
-        glUniform2fv(glGetUniformLocation(shader, "uv_max"), 1, glm::value_ptr(uv_max));
-
-        glBindVertexArray(vao);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
+    void draw(SpriteBatch& batch, int layer) {
+        batch.add(texture, SpriteInstance(quad.position, quad.dimensions, uv_min, uv_max), layer);
     }
 };
 
+// Inimigo do enemies-spritesheet1.png: 2 quadros (colunas) x 12 tipos (linhas)
+struct Enemy {
+    glm::vec2 position;
+    glm::vec2 velocity;
+    int type;
+    float phase;
+};
+
 bool load_texture(const char* file_name, GLuint* tex) {
     int x, y, n;
     unsigned char* image_data = stbi_load(file_name, &x, &y, &n, 4);
@@ -70,72 +64,6 @@ bool load_texture(const char* file_name, GLuint* tex) {
     return true;
 }
 
-GLuint createQuadVAO() {
-    GLfloat vertices[] = {
-        // x, y, z      // cor       // tex coord
-        -0.5f, -0.5f, 0.0f, 1, 1, 1, 0.0f, 1.0f,
-         0.5f, -0.5f, 0.0f, 1, 1, 1, 1.0f, 1.0f,
-         0.5f,  0.5f, 0.0f, 1, 1, 1, 1.0f, 0.0f,
-
-        -0.5f, -0.5f, 0.0f, 1, 1, 1, 0.0f, 1.0f,
-         0.5f,  0.5f, 0.0f, 1, 1, 1, 1.0f, 0.0f,
-        -0.5f,  0.5f, 0.0f, 1, 1, 1, 0.0f, 0.0f
-    };
-
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // posições
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-    glEnableVertexAttribArray(0);
-    // cores
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // textura
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-    return VAO;
-}
-
-const char* vertex_shader = R"(
-    #version 410
-    layout (location = 0) in vec3 vPosition;
-    layout (location = 1) in vec3 vColor;
-    layout (location = 2) in vec2 vTexture;
-
-    uniform mat4 proj;
-    uniform mat4 matrix;
-    uniform vec2 uv_min;
-    uniform vec2 uv_max;
-
-    out vec2 text_map;
-    out vec3 color;
-
-    void main() {
-        color = vColor;
-        // ajusta UV: (0,0)->uv_min, (1,1)->uv_max
-        text_map = mix(uv_min, uv_max, vTexture); 
-        gl_Position = proj * matrix * vec4(vPosition, 1.0);
-    }
-)";
-
-const char* fragment_shader = R"(
-    #version 410
-    in vec2 text_map;
-    uniform sampler2D basic_texture;
-    out vec4 frag_color;
-    void main() {
-        frag_color = texture(basic_texture, text_map);
-    }
-)";
-
 int main() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -158,18 +86,8 @@ int main() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &vertex_shader, nullptr);
-    glCompileShader(vs);
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &fragment_shader, nullptr);
-    glCompileShader(fs);
-    GLuint shader = glCreateProgram();
-    glAttachShader(shader, vs);
-    glAttachShader(shader, fs);
-    glLinkProgram(shader);
-
-    GLuint vao = createQuadVAO();
+    SpriteBatch batch;
+    batch.init();
 
     GLuint tex1, tex2, tex3, tex4, tex5;
 
@@ -179,37 +97,86 @@ int main() {
     if (!load_texture("../src/Modulo4/Gorgon_1/Attack_1.png", &tex4)) return -1;
     if (!load_texture("../src/Modulo4/Karasu_tengu/Jump.png", &tex5)) return -1;
 
+    GLuint texEnemies;
+    if (!load_texture("../assets/sprites/enemies-spritesheet1.png", &texEnemies)) return -1;
+
     glm::mat4 proj = glm::ortho(0.0f, float(WIDTH), 0.0f, float(HEIGHT), -1.0f, 1.0f);
 
+    // O lote só garante a ordem entre camadas: fundo na 0, personagens na 1, inimigos na 2
+    Sprite background(tex1, Quad{{WIDTH / 2, HEIGHT / 2}, {WIDTH, HEIGHT}});
     std::vector<Sprite> sprites;
-    sprites.emplace_back(vao, tex1, shader, Quad{{WIDTH / 2, HEIGHT / 2}, {WIDTH, HEIGHT}});
-    sprites.emplace_back(vao, tex2, shader, Quad{{200, 150}, {250, 250}});
+    sprites.emplace_back(tex2, Quad{{200, 150}, {250, 250}});
     int cols = 8, rows = 1;
     int col = 1, row = 0;
     glm::vec2 uv_min = { col / float(cols), row / float(rows) };
     glm::vec2 uv_max = { (col + 1) / float(cols), (row + 1) / float(rows) };
-    sprites.emplace_back(vao, tex3, shader, Quad{{400, 150}, {250, 250}}, uv_min, uv_max);
+    sprites.emplace_back(tex3, Quad{{400, 150}, {250, 250}}, uv_min, uv_max);
     cols = 16, rows = 1;
     col = 15, row = 0;
     uv_min = { col / float(cols), row / float(rows) };
     uv_max = { (col + 1) / float(cols), (row + 1) / float(rows) };
-    sprites.emplace_back(vao, tex4, shader, Quad{{600, 150}, {250, 250}}, uv_min, uv_max);
+    sprites.emplace_back(tex4, Quad{{600, 150}, {250, 250}}, uv_min, uv_max);
     cols = 15, rows = 1;
     col = 14, row = 0;
     uv_min = { col / float(cols), row / float(rows) };
     uv_max = { (col + 1) / float(cols), (row + 1) / float(rows) };
-    sprites.emplace_back(vao, tex5, shader, Quad{{300, 400}, {250, 250}}, uv_min, uv_max);
+    sprites.emplace_back(tex5, Quad{{300, 400}, {250, 250}}, uv_min, uv_max);
+
+    // Espaço adiciona 1000 inimigos animados, para testar o lote com muitas instâncias
+    std::vector<Enemy> enemies;
+    bool spaceHeld = false;
+    double lastTime = glfwGetTime();
+    double reportTime = lastTime;
+    int frames = 0;
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
+
+        double now = glfwGetTime();
+        float dt = float(now - lastTime);
+        lastTime = now;
+
+        bool space = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+        if (space && !spaceHeld) {
+            for (int i = 0; i < 1000; i++) {
+                Enemy e;
+                e.position = {float(rand() % WIDTH), float(rand() % HEIGHT)};
+                e.velocity = {float(rand() % 200 - 100), float(rand() % 200 - 100)};
+                e.type = rand() % 12;
+                e.phase = float(rand() % 100) / 100.0f;
+                enemies.push_back(e);
+            }
+        }
+        spaceHeld = space;
+
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        batch.begin();
+        background.draw(batch, 0);
         for (auto& sprite : sprites) {
-            sprite.draw(proj);
+            sprite.draw(batch, 1);
+        }
+        for (auto& e : enemies) {
+            e.position += e.velocity * dt;
+            if (e.position.x < 0 || e.position.x > WIDTH) e.velocity.x = -e.velocity.x;
+            if (e.position.y < 0 || e.position.y > HEIGHT) e.velocity.y = -e.velocity.y;
+            glm::vec2 uv_min = {0.0f, e.type / 12.0f};
+            glm::vec2 uv_max = {0.5f, (e.type + 1) / 12.0f};
+            float frame = float(int(now * 4.0 + e.phase * 2.0) % 2);
+            batch.add(texEnemies, SpriteInstance(e.position, {40, 40}, uv_min, uv_max, {0, 0}, frame), 2);
         }
+        batch.end(proj);
 
         glfwSwapBuffers(window);
+
+        frames++;
+        if (now - reportTime > 2.0) {
+            std::cout << enemies.size() << " inimigos, " << batch.getDrawCalls() << " draw calls, "
+                      << (now - reportTime) / frames * 1000.0 << " ms/quadro" << std::endl;
+            reportTime = now;
+            frames = 0;
+        }
     }
 
     glfwTerminate();
@@ -12,6 +12,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "ParallaxBackground.h"
+#include "SpriteAnimator.h"
+#include "SpriteBatch.h"
+
 const GLint WIDTH = 800;
 const GLint HEIGHT = 600;
 
@@ -47,54 +51,35 @@ struct Quad {
 
 class Sprite {
 public:
-    GLuint vao;
     GLuint texture;
-    GLuint shader;
     Quad quad;
     glm::vec2 uv_min, uv_max;
 
-    Sprite(GLuint vao, GLuint texture, GLuint shader, Quad quad,
+    Sprite(GLuint texture, Quad quad,
            glm::vec2 uv_min = {0,0}, glm::vec2 uv_max = {1,1}) :
-           vao(vao), texture(texture), shader(shader), quad(quad),
+           texture(texture), quad(quad),
            uv_min(uv_min), uv_max(uv_max) {}
 
-    void draw(const glm::mat4& proj, const glm::vec2& offsetUV = glm::vec2(0.0f)) {
-        glUseProgram(shader);
-
-        glUniformMatrix4fv(glGetUniformLocation(shader, "proj"), 1, GL_FALSE, glm::value_ptr(proj));
-
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(quad.position.x, quad.position.y, 0.0f));
-        model = glm::scale(model, glm::vec3(quad.dimensions.x, quad.dimensions.y, 1.0f));
-        glUniformMatrix4fv(glGetUniformLocation(shader, "model"), 1, GL_FALSE, glm::value_ptr(model));
-
-        glUniform2fv(glGetUniformLocation(shader, "offset"), 1, glm::value_ptr(offsetUV));
-
-        glUniform2fv(glGetUniformLocation(shader, "uv_min"), 1, glm::value_ptr(uv_min));
-        glUniform2fv(glGetUniformLocation(shader, "uv_max"), 1, glm::value_ptr(uv_max));
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(shader, "texture1"), 0);
-
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
+    void draw(SpriteBatch& batch, int layer, const glm::vec2& offsetUV = glm::vec2(0.0f)) {
+        batch.add(texture, SpriteInstance(quad.position, quad.dimensions, uv_min, uv_max, offsetUV), layer);
     }
 };
 
-struct Layer {
-    Sprite sprite;
-    glm::vec2 offset;
-    float parallax_factor;
-};
-
 int main() {
-    const int startFrame = 5;  // 6º sprite (index 5)
-    const int endFrame = 11;   // 12º sprite (index 11)
-    int currentFrame = startFrame;
-    float frameDuration = 0.1f; // tempo em segundos para cada frame
-    float frameTimer = 0.0f;
+    // Quadros do personagem: clipe "pulo" em animacoes.txt (ver SpriteAnimator.h)
+    std::vector<AnimationClip> clips;
+    std::string err;
+    if (!loadAnimationClips("../src/Modulo5/animacoes.txt", clips, err)) {
+        std::cerr << "Erro: " << err << std::endl;
+        return -1;
+    }
+    SpriteAnimator animator(clips);
+    int jumpClip = animator.findClip("pulo");
+    if (jumpClip < 0) {
+        std::cerr << "Erro: clipe \"pulo\" ausente em animacoes.txt" << std::endl;
+        return -1;
+    }
+    int player = animator.add(jumpClip);
 
     if (!glfwInit()) {
         std::cerr << "Falha ao inicializar GLFW\n";
@@ -122,89 +107,23 @@ int main() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    const char* vertex_shader_src =
-        "#version 410 core\n"
-        "layout(location = 0) in vec3 aPos;\n"
-        "layout(location = 1) in vec2 aTexCoord;\n"
-        "uniform mat4 proj;\n"
-        "uniform mat4 model;\n"
-        "uniform vec2 uv_min;\n"
-        "uniform vec2 uv_max;\n"
-        "out vec2 TexCoord;\n"
-        "void main() {\n"
-        "    TexCoord = mix(uv_min, uv_max, aTexCoord);\n"
-        "    gl_Position = proj * model * vec4(aPos, 1.0);\n"
-        "}\n";
-
-    const char* fragment_shader_src =
-        "#version 410 core\n"
-        "in vec2 TexCoord;\n"
-        "uniform sampler2D texture1;\n"
-        "uniform vec2 offset;\n"
-        "out vec4 FragColor;\n"
-        "void main() {\n"
-            "vec2 uv = fract(TexCoord + offset);"
-        "    FragColor = texture(texture1, uv);\n"
-        "}\n";
-
-    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_shader_src, nullptr);
-    glCompileShader(vertex_shader);
-
-    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_shader_src, nullptr);
-    glCompileShader(fragment_shader);
-
-    GLuint shader = glCreateProgram();
-    glAttachShader(shader, vertex_shader);
-    glAttachShader(shader, fragment_shader);
-    glLinkProgram(shader);
-
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
-
-    float vertices[] = {
-        -0.5f, -0.5f, 0.f,  0.f, 1.f,
-         0.5f, -0.5f, 0.f,  1.f, 1.f,
-         0.5f,  0.5f, 0.f,  1.f, 0.f,
-
-        -0.5f, -0.5f, 0.f,  0.f, 1.f,
-         0.5f,  0.5f, 0.f,  1.f, 0.f,
-        -0.5f,  0.5f, 0.f,  0.f, 0.f
-    };
-
-    GLuint vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-
-    glBindVertexArray(vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindVertexArray(0);
+    SpriteBatch batch;
+    batch.init();
 
     float parallax_factors[10] = {0.05f, 0.1f, 0.15f, 0.2f, 0.3f, 0.4f, 0.5f, 0.65f, 0.8f, 1.0f};
 
-    std::vector<Layer> layers;
-
-    for (int i = 0; i < 7; ++i) {
-        GLuint tex;
-        std::string path = "../src/Modulo4/PNG/platformer_background_3/Layers/" + std::to_string(i + 1) + ".png";
-        if (!load_texture(path.c_str(), &tex)) {
-            std::cerr << "Erro ao carregar textura: " << path << std::endl;
-            return -1;
-        }
-        Quad q = {{WIDTH / 2.f, HEIGHT / 2.f}, {WIDTH, HEIGHT}};
-        Sprite s(vao, tex, shader, q);
-        layers.push_back({s, {0.f, 0.f}, parallax_factors[i]});
+    // Fundo: as 7 camadas numa textura array, compostas num draw só
+    ParallaxBackground background;
+    std::vector<std::string> layerFiles;
+    for (int i = 0; i < 7; ++i)
+        layerFiles.push_back("../src/Modulo4/PNG/platformer_background_3/Layers/" + std::to_string(i + 1) + ".png");
+    if (!background.load(layerFiles, err)) {
+        std::cerr << "Erro ao carregar o fundo: " << err << std::endl;
+        return -1;
     }
+    for (int i = 0; i < background.getLayers(); ++i)
+        background.setFactor(i, parallax_factors[i]);
+    glm::vec2 camera = {0.f, 0.f};
 
     GLuint texChar;
     if (!load_texture("../src/Modulo4/Karasu_tengu/Jump.png", &texChar)) {
@@ -216,11 +135,9 @@ int main() {
     glm::vec2 uv_min = { col / float(cols), row / float(rows) };
     glm::vec2 uv_max = { (col + 1) / float(cols), (row + 1) / float(rows) };
     Sprite character(vao, texChar, shader, charQuad, uv_min, uv_max);*/
-    int cols = 15;
-    int rows = 1;
-    glm::vec2 uv_min = {startFrame / float(cols), 0.0f};
-    glm::vec2 uv_max = {(startFrame + 1) / float(cols), 1.0f};
-    Sprite character(vao, texChar, shader, charQuad, uv_min, uv_max);
+    float du, dv;
+    animator.getFrameSize(player, du, dv);
+    Sprite character(texChar, charQuad);
 
     glm::vec2 playerPos = {WIDTH / 2.f, HEIGHT / 2.f};
 
@@ -234,17 +151,9 @@ int main() {
         float deltaTime = float(currentTime - lastTime);
         lastTime = currentTime;
 
-        frameTimer += deltaTime;
-        if (frameTimer >= frameDuration) {
-            frameTimer = 0.0f;
-            currentFrame++;
-            if (currentFrame > endFrame) currentFrame = startFrame;
-
-            character.uv_min.x = currentFrame / float(cols);
-            character.uv_max.x = (currentFrame + 1) / float(cols);
-            character.uv_min.y = 0.0f;
-            character.uv_max.y = 1.0f;
-        }
+        animator.update(deltaTime);
+        character.uv_min = {animator.getU()[player], animator.getV()[player]};
+        character.uv_max = character.uv_min + glm::vec2(du, dv);
 
         glm::vec2 movement(0.f, 0.f);
         const float speed = 1.5f;
@@ -257,18 +166,18 @@ int main() {
         playerPos.x = glm::clamp(playerPos.x, 0.0f, float(WIDTH));
         playerPos.y = glm::clamp(playerPos.y, 0.0f, float(HEIGHT));
 
-        for (auto& layer : layers) {layer.offset.x += movement.x * layer.parallax_factor;}
+        camera.x += movement.x;
 
         glClearColor(0.1f, 0.2f, 0.3f, 1.f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        for (auto& layer : layers) {
-            glm::vec2 offsetUV = layer.offset / glm::vec2(WIDTH, HEIGHT);
-            layer.sprite.draw(proj, offsetUV);
-        }
+        // Cada camada anda camera * fator dela; em UV, uma tela = 1
+        background.draw(camera.x / WIDTH, camera.y / HEIGHT);
 
+        batch.begin();
         character.quad.position = playerPos;
-        character.draw(proj, {0.f, 0.f});
+        character.draw(batch, 0);
+        batch.end(proj);
 
         glfwSwapBuffers(window);
     }
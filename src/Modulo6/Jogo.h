@@ -0,0 +1,393 @@
+// Regras do Trabfinal sem OpenGL nem GLFW: o estado só muda por Jogo::passo(),
+// um comando por vez, e a mesma semente com os mesmos comandos dá sempre o
+// mesmo resultado (o sorteio das moedas usa um gerador próprio, não o rand()).
+// O Trabfinal desenha a partir de estado(); Ferramentas/ReplayJogo roda
+// gravações de comandos na velocidade máxima, sem contexto OpenGL.
+#ifndef Jogo_h
+#define Jogo_h
+
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BitGrid.h"
+#include "MapConfig.h"
+
+enum class Comando : unsigned char
+{
+	Nenhum,
+	N,
+	S,
+	E,
+	W,
+	NE,
+	NW,
+	SE,
+	SW,
+};
+
+// Teclas do Trabfinal: Q W E / A D / Z X C. As gravações usam as mesmas letras.
+inline Comando comandoDaTecla(char tecla)
+{
+	switch (tecla)
+	{
+	case 'Q':
+		return Comando::NW;
+	case 'W':
+		return Comando::N;
+	case 'E':
+		return Comando::NE;
+	case 'A':
+		return Comando::W;
+	case 'D':
+		return Comando::E;
+	case 'Z':
+		return Comando::SW;
+	case 'X':
+		return Comando::S;
+	case 'C':
+		return Comando::SE;
+	default:
+		return Comando::Nenhum;
+	}
+}
+
+inline char teclaDoComando(Comando c)
+{
+	static const char teclas[] = {'\0', 'W', 'X', 'D', 'A', 'E', 'Q', 'C', 'Z'};
+	return teclas[(int)c];
+}
+
+// Bits devolvidos por Jogo::passo()
+enum EventoJogo
+{
+	EVENTO_MOVEU = 1 << 0,
+	EVENTO_MORREU = 1 << 1,		  // pisou em tile perigoso e voltou ao início
+	EVENTO_BLOQUEADO = 1 << 2,
+	EVENTO_DESCONHECIDO = 1 << 3, // tile sem propriedade de movimento
+	EVENTO_FORA = 1 << 4,		  // tentou sair do mapa
+	EVENTO_MOEDA = 1 << 5,
+	EVENTO_VENCEU = 1 << 6,
+	EVENTO_PERDEU = 1 << 7,
+};
+
+struct Moeda
+{
+	int i, j; // linha e coluna do tile
+};
+
+struct EstadoJogo
+{
+	int player_i, player_j;
+	int vida;
+	int pontuacao;
+	int totalMoedas;
+	std::vector<Moeda> moedas; // só as que ainda não foram coletadas, em ordem qualquer
+	bool fim;		 // venceu ou perdeu: passo() não faz mais nada
+	uint64_t passos; // comandos aplicados desde reiniciar()
+};
+
+// Um bit por tile para cada propriedade, tirados do tileProps.txt (e das
+// moedas), para consultas de retângulo: planos.perigoso.any(j0, i0, j1, i1)
+// diz se há perigo por perto, planos.moeda.count(...) quantas moedas há na
+// área. Atenção: BitGrid recebe (coluna, linha), ou seja (j, i).
+struct PlanosMapa
+{
+	BitGrid caminhavel;
+	BitGrid perigoso;
+	BitGrid bloqueado;
+	BitGrid moeda; // moedas ainda não coletadas
+};
+
+class Jogo
+{
+	int rows, cols;
+	const unsigned char *tiles; // de MapConfig::matrix, não copiado
+	std::vector<TileType> tipos;
+	int inicioRow, inicioCol;
+	int maxMoedas;
+	EstadoJogo e;
+	std::vector<int> moedaEm; // por tile: índice em e.moedas, ou -1 se não há moeda
+	PlanosMapa planos;
+	uint32_t rng;
+
+	// xorshift32: igual em qualquer plataforma, ao contrário do rand()
+	uint32_t sortear()
+	{
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		return rng;
+	}
+
+	static void direcao(Comando c, int &di, int &dj)
+	{
+		static const signed char d[][2] = {{0, 0}, {-1, 0}, {+1, 0}, {0, +1}, {0, -1}, {-1, +1}, {-1, -1}, {+1, +1}, {+1, -1}};
+		di = d[(int)c][0];
+		dj = d[(int)c][1];
+	}
+
+public:
+	static const int VIDAS = 3;
+	static const int MAX_MOEDAS = 15;
+
+	// O mapa (cfg.matrix) tem de continuar valendo enquanto o jogo existir
+	Jogo(const MapConfig &cfg, const std::vector<TileType> &tileTypes, int maxMoedas = MAX_MOEDAS)
+	{
+		this->maxMoedas = maxMoedas;
+		rows = cfg.rows;
+		cols = cfg.cols;
+		tiles = cfg.matrix;
+		tipos = tileTypes;
+		inicioRow = cfg.playerInicialRow;
+		inicioCol = cfg.playerInicialCol;
+
+		planos.caminhavel.resize(rows, cols);
+		planos.perigoso.resize(rows, cols);
+		planos.bloqueado.resize(rows, cols);
+		planos.moeda.resize(rows, cols);
+		for (int i = 0; i < rows; i++)
+			for (int j = 0; j < cols; j++)
+			{
+				TileType tipo = tipoEm(i, j);
+				planos.caminhavel.set(j, i, tipo == TileType::Walkable);
+				planos.perigoso.set(j, i, tipo == TileType::Deadly);
+				planos.bloqueado.set(j, i, tipo == TileType::Blocked);
+			}
+		reiniciar(1);
+	}
+
+	TileType tipoEm(int i, int j) const
+	{
+		int id = tiles[i * cols + j];
+		return id < (int)tipos.size() ? tipos[id] : TileType::Unknown;
+	}
+
+	// 1 nos tiles em que o jogador pode andar sem perder vida, 0 nos outros,
+	// linha a linha (a grade do PathGrid de Pathfinding.h)
+	void gradeCaminhavel(std::vector<unsigned char> &grade) const
+	{
+		grade.resize((size_t)rows * cols);
+		for (int i = 0; i < rows; i++)
+			for (int j = 0; j < cols; j++)
+				grade[i * cols + j] = planos.caminhavel.test(j, i);
+	}
+
+	// Volta ao começo: vidas cheias e moedas sorteadas de novo (até maxMoedas,
+	// 10% de chance em cada tile caminhável, em ordem de linha)
+	void reiniciar(uint32_t semente)
+	{
+		rng = semente ? semente : 0x9E3779B9u; // xorshift não sai do zero
+		e.player_i = inicioRow;
+		e.player_j = inicioCol;
+		e.vida = VIDAS;
+		e.pontuacao = 0;
+		e.fim = false;
+		e.passos = 0;
+		e.moedas.clear();
+		moedaEm.assign((size_t)rows * cols, -1);
+		planos.moeda.clear();
+		for (int i = 0; i < rows && (int)e.moedas.size() < maxMoedas; i++)
+			for (int j = 0; j < cols && (int)e.moedas.size() < maxMoedas; j++)
+			{
+				if (!planos.caminhavel.test(j, i) || (i == inicioRow && j == inicioCol))
+					continue;
+				if (sortear() % 10 == 0)
+				{
+					moedaEm[i * cols + j] = (int)e.moedas.size();
+					e.moedas.push_back({i, j});
+					planos.moeda.set(j, i);
+				}
+			}
+		e.totalMoedas = (int)e.moedas.size();
+	}
+
+	// Aplica um comando: movimento, tile perigoso, moeda e fim de jogo.
+	// Devolve os EVENTO_* que aconteceram (0 se o jogo já acabou).
+	unsigned passo(Comando c)
+	{
+		if (e.fim || c == Comando::Nenhum)
+			return 0;
+		e.passos++;
+
+		int di, dj;
+		direcao(c, di, dj);
+		int ni = e.player_i + di, nj = e.player_j + dj;
+		unsigned eventos = 0;
+
+		if (ni < 0 || nj < 0 || ni >= rows || nj >= cols)
+			eventos |= EVENTO_FORA;
+		else
+		{
+			if (planos.caminhavel.test(nj, ni))
+			{
+				e.player_i = ni;
+				e.player_j = nj;
+				eventos |= EVENTO_MOVEU;
+			}
+			else if (planos.perigoso.test(nj, ni))
+			{
+				e.player_i = inicioRow;
+				e.player_j = inicioCol;
+				e.vida--;
+				eventos |= EVENTO_MORREU;
+			}
+			else if (planos.bloqueado.test(nj, ni))
+				eventos |= EVENTO_BLOQUEADO;
+			else
+				eventos |= EVENTO_DESCONHECIDO;
+		}
+
+		if (coletar(e.player_i, e.player_j))
+		{
+			e.pontuacao++;
+			eventos |= EVENTO_MOEDA;
+		}
+
+		if (e.vida <= 0)
+		{
+			e.fim = true;
+			eventos |= EVENTO_PERDEU;
+		}
+		else if (e.totalMoedas > 0 && e.moedas.empty())
+		{
+			e.fim = true;
+			eventos |= EVENTO_VENCEU;
+		}
+		return eventos;
+	}
+
+	const EstadoJogo &estado() const
+	{
+		return e;
+	}
+
+	const PlanosMapa &planosDoMapa() const
+	{
+		return planos;
+	}
+
+	// Resumo do estado (FNV-1a), para comparar execuções
+	uint64_t hash() const
+	{
+		uint64_t h = 1469598103934665603ull;
+		auto mistura = [&h](uint64_t v)
+		{
+			h = (h ^ v) * 1099511628211ull;
+		};
+		mistura(e.player_i);
+		mistura(e.player_j);
+		mistura(e.vida);
+		mistura(e.pontuacao);
+		mistura(e.fim);
+		mistura(e.passos);
+		for (const Moeda &m : e.moedas)
+			mistura((uint64_t)m.i * cols + m.j);
+		return h;
+	}
+
+private:
+	// Tira a moeda do tile (i, j), se houver: a última da lista ocupa o lugar
+	// dela, então não é preciso procurar nem deslocar nada
+	bool coletar(int i, int j)
+	{
+		int k = moedaEm[i * cols + j];
+		if (k < 0)
+			return false;
+		moedaEm[i * cols + j] = -1;
+		planos.moeda.set(j, i, false);
+		Moeda ultima = e.moedas.back();
+		e.moedas.pop_back();
+		if (k < (int)e.moedas.size())
+		{
+			e.moedas[k] = ultima;
+			moedaEm[ultima.i * cols + ultima.j] = k;
+		}
+		return true;
+	}
+};
+
+// Gravação: "semente N", opcionalmente "moedas N" (o maxMoedas, se não for o
+// padrão) e depois os comandos como letras (espaços e quebras de linha são
+// ignorados; linhas começando com # são comentários)
+inline bool lerGravacao(const std::string &path, uint32_t &semente, int &maxMoedas, std::vector<Comando> &comandos,
+						std::string &err)
+{
+	std::ifstream in(path);
+	if (!in)
+	{
+		err = "Não foi possível abrir a gravação: " + path;
+		return false;
+	}
+	std::string palavra;
+	bool temSemente = false;
+	maxMoedas = Jogo::MAX_MOEDAS;
+	while (in >> palavra)
+	{
+		if (palavra[0] == '#')
+		{
+			std::getline(in, palavra);
+			continue;
+		}
+		if (palavra == "semente" || palavra == "moedas")
+		{
+			// número sem sinal; qualquer outra coisa (ou nada) é erro, e não o fim da gravação
+			std::string valor;
+			in >> valor;
+			char *fim = NULL;
+			unsigned long v = valor.empty() || !isdigit((unsigned char)valor[0]) ? 0 : strtoul(valor.c_str(), &fim, 10);
+			if (!fim || *fim || (palavra == "moedas" && v > (unsigned long)INT_MAX))
+			{
+				err = path + ": valor inválido para " + palavra + ": '" + valor + "'";
+				return false;
+			}
+			if (palavra == "semente")
+			{
+				semente = (uint32_t)v;
+				temSemente = true;
+			}
+			else
+				maxMoedas = (int)v;
+			continue;
+		}
+		for (char tecla : palavra)
+		{
+			Comando c = comandoDaTecla(tecla);
+			if (c == Comando::Nenhum)
+			{
+				err = path + ": comando inválido '" + std::string(1, tecla) + "'";
+				return false;
+			}
+			comandos.push_back(c);
+		}
+	}
+	if (!temSemente)
+	{
+		err = path + ": falta a linha \"semente N\"";
+		return false;
+	}
+	return true;
+}
+
+inline bool gravarGravacao(const std::string &path, uint32_t semente, int maxMoedas, const std::vector<Comando> &comandos)
+{
+	std::ofstream out(path);
+	out << "# Trabfinal: comandos (Q W E / A D / Z X C)\n";
+	out << "semente " << semente << "\n";
+	if (maxMoedas != Jogo::MAX_MOEDAS)
+		out << "moedas " << maxMoedas << "\n";
+	for (size_t k = 0; k < comandos.size(); k++)
+	{
+		out << teclaDoComando(comandos[k]);
+		if (k % 64 == 63)
+			out << "\n";
+	}
+	out << "\n";
+	return (bool)out;
+}
+
+#endif
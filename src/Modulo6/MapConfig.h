@@ -0,0 +1,529 @@
+// Leitura do mapa do Trabfinal: texto (config/tileMap.txt + config/tileProps.txt)
+// ou binário (.tbin, ver common/M5-6/BinaryMap.h), que é mapeado em memória e
+// usado sem cópia. Compartilhado com a ferramenta Ferramentas/ConverteMapa.
+#ifndef MapConfig_h
+#define MapConfig_h
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BinaryMap.h"
+
+enum class TileType
+{
+	Walkable,
+	Deadly,
+	Blocked,
+	Unknown,
+	Coin,
+};
+
+struct MapConfig
+{
+	std::string tilesetFile;
+	int nTiles;
+	int tileW, tileH;
+	int rows, cols;
+	const unsigned char *matrix;			// rows*cols ids, linha a linha: aponta para matrixTexto ou para o .tbin
+	std::vector<unsigned char> matrixTexto; // ids lidos do .txt
+	BinaryMap binario;						// .tbin mapeado (aberto só se o mapa veio dele)
+	int playerInicialRow, playerInicialCol;
+};
+
+// Cursor sobre um arquivo de configuração mapeado em memória. Anda uma vez
+// pelo texto contando as linhas; seções e valores são lidos no lugar, sem
+// copiar linhas nem montar strings.
+struct ConfigCursor
+{
+	const char *p, *end;
+	int line;
+	const std::string &path;
+
+	ConfigCursor(const char *begin, const char *end, const std::string &path) : p(begin), end(end), line(1), path(path)
+	{
+		if (end - begin >= 3 && memcmp(begin, "\xEF\xBB\xBF", 3) == 0) // BOM do UTF-8
+			this->p += 3;
+	}
+
+	// Espaços, tabs e \r, sem passar para a próxima linha
+	void skipBlanks()
+	{
+		while (this->p < this->end && (*this->p == ' ' || *this->p == '\t' || *this->p == '\r'))
+			this->p++;
+	}
+
+	bool atLineEnd() const
+	{
+		return this->p == this->end || *this->p == '\n';
+	}
+
+	// Pula o que resta da linha e vai para o começo da próxima
+	void nextLine()
+	{
+		const char *nl = (const char *)memchr(this->p, '\n', this->end - this->p);
+		this->p = nl ? nl + 1 : this->end;
+		this->line++;
+	}
+
+	// O resto da linha, sem os espaços laterais
+	std::string_view restOfLine()
+	{
+		const char *begin = this->p;
+		const char *nl = (const char *)memchr(this->p, '\n', this->end - this->p);
+		this->p = nl ? nl : this->end;
+		const char *last = this->p;
+		while (last > begin && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r'))
+			last--;
+		return std::string_view(begin, last - begin);
+	}
+
+	bool fail(std::string &err, const std::string &msg) const
+	{
+		err = this->path + ":" + std::to_string(this->line) + ": " + msg;
+		return false;
+	}
+
+	// "[nome]" sozinho na linha (p no '['); deixa p no fim da linha
+	bool readSection(std::string_view &name, std::string &err)
+	{
+		std::string_view text = this->restOfLine();
+		if (text.size() < 2 || text.back() != ']')
+			return this->fail(err, "esperado [seção], achou \"" + std::string(text) + "\"");
+		name = text.substr(1, text.size() - 2);
+		return true;
+	}
+
+	// Inteiro seguido de espaço ou fim de linha
+	bool readInt(int &v, std::string &err)
+	{
+		std::from_chars_result r = std::from_chars(this->p, this->end, v);
+		if (r.ec == std::errc::result_out_of_range)
+			return this->fail(err, "número grande demais: " + std::string(this->p, r.ptr));
+		if (r.ec != std::errc() || (r.ptr < this->end && *r.ptr != ' ' && *r.ptr != '\t' && *r.ptr != '\r' && *r.ptr != '\n'))
+			return this->fail(err, "esperado um número, achou \"" + std::string(this->token()) + "\"");
+		this->p = r.ptr;
+		return true;
+	}
+
+	// Palavra em p (até espaço ou fim de linha), para as mensagens de erro
+	std::string_view token() const
+	{
+		const char *q = this->p;
+		while (q < this->end && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n')
+			q++;
+		return std::string_view(this->p, q - this->p);
+	}
+};
+
+// Mapeia o arquivo inteiro; um arquivo vazio dá um texto vazio
+inline bool openConfig(const std::string &path, MappedFile &file, const char *&begin, const char *&end, std::string &err)
+{
+	begin = end = NULL;
+	if (file.open(path))
+	{
+		begin = (const char *)file.getData();
+		end = begin + file.getSize();
+		return true;
+	}
+	std::error_code ec;
+	if (std::filesystem::file_size(path, ec) == 0 && !ec)
+		return true;
+	err = "Não foi possível abrir o arquivo de configuração: " + path;
+	return false;
+}
+
+// Lê o config/tileMap.txt numa passada só pelo arquivo mapeado. Se [rows] e
+// [columns] vêm antes de [matrix] (como nos arquivos do jogo e nos gerados),
+// a matriz já é alocada com o tamanho final e os ids vão direto para ela.
+// Erros dizem o arquivo e a linha.
+inline bool loadMapConfig(const std::string &path, MapConfig &cfg, std::string &err)
+{
+	MappedFile file;
+	const char *begin, *end;
+	if (!openConfig(path, file, begin, end, err))
+		return false;
+
+	enum
+	{
+		NONE = -1,
+		FILE_NAME,
+		N_TILES,
+		WIDTH,
+		HEIGHT,
+		ROWS,
+		COLUMNS,
+		ROW_START,
+		COLUMN_START,
+		MATRIX,
+		SECTIONS
+	};
+	static const char *names[SECTIONS] = {"file", "nTiles", "width", "height", "rows", "columns",
+										  "rowInicialPosition", "columnInicialPosition", "matrix"};
+	int *values[SECTIONS] = {NULL, &cfg.nTiles, &cfg.tileW, &cfg.tileH, &cfg.rows, &cfg.cols,
+							 &cfg.playerInicialRow, &cfg.playerInicialCol, NULL};
+	bool seen[SECTIONS] = {};
+	bool filled[SECTIONS] = {}; // seções de um valor só que já têm o valor
+
+	std::vector<unsigned char> tiles;
+	unsigned char *out = NULL; // escrita direta em tiles, se o tamanho já era conhecido
+	size_t count = 0, total = 0;
+	int matrixLine = 0;
+
+	ConfigCursor c(begin, end, path);
+	int section = NONE;
+	while (c.p < c.end)
+	{
+		c.skipBlanks();
+		if (c.atLineEnd())
+		{
+			c.nextLine();
+			continue;
+		}
+
+		if (*c.p == '[')
+		{
+			std::string_view name;
+			if (!c.readSection(name, err))
+				return false;
+			section = NONE;
+			for (int s = 0; s < SECTIONS && section == NONE; s++)
+				if (name == names[s])
+					section = s;
+			if (section == NONE)
+				return c.fail(err, "seção [" + std::string(name) + "] desconhecida");
+			seen[section] = true;
+
+			if (section == MATRIX && !matrixLine)
+			{
+				matrixLine = c.line;
+				if (seen[ROWS] && seen[COLUMNS] && cfg.rows > 0 && cfg.cols > 0)
+				{
+					// cada id ocupa pelo menos um caractere mais o separador
+					total = (size_t)cfg.rows * cfg.cols;
+					if (total > (size_t)(c.end - c.p + 1) / 2)
+						return c.fail(err, "rows*columns = " + std::to_string(total) + ", mas o resto do arquivo só tem " +
+											   std::to_string(c.end - c.p) + " bytes");
+					tiles.resize(total);
+					out = tiles.data();
+				}
+			}
+			c.nextLine();
+			continue;
+		}
+
+		if (section == NONE)
+			return c.fail(err, "valor fora de uma seção: \"" + std::string(c.token()) + "\"");
+
+		if (section == MATRIX)
+		{
+			// Laço quente: cópias locais, porque as escritas em out (unsigned
+			// char *) podem apontar para qualquer coisa e obrigariam o
+			// compilador a reler c.p e c.end a cada id
+			const char *p = c.p, *e = c.end;
+			size_t n = count;
+			while (true)
+			{
+				while (p < e && (*p == ' ' || *p == '\t' || *p == '\r'))
+					p++;
+				// "d d d d ": quatro ids de um dígito separados por espaço, o
+				// caso comum, saem de uma leitura de 8 bytes (bytes pares
+				// dígitos, ímpares espaços; a soma deixa o bit 15 de cada par
+				// ligado se o byte não era dígito)
+				if (out && e - p >= 8 && total - n >= 4)
+				{
+					uint64_t w;
+					memcpy(&w, p, 8);
+					uint64_t d = (w & 0x00FF00FF00FF00FFull) ^ 0x0030003000300030ull;
+					if ((w & 0xFF00FF00FF00FF00ull) == 0x2000200020002000ull &&
+						((d + 0x7FF67FF67FF67FF6ull) & 0x8000800080008000ull) == 0)
+					{
+						out[n] = (unsigned char)d;
+						out[n + 1] = (unsigned char)(d >> 16);
+						out[n + 2] = (unsigned char)(d >> 32);
+						out[n + 3] = (unsigned char)(d >> 48);
+						n += 4;
+						p += 8;
+						continue;
+					}
+				}
+				if (p == e || *p == '\n')
+					break;
+				unsigned v = (unsigned char)*p - '0';
+				const char *q = p + 1;
+				if (v < 10 && (q == e || (unsigned)((unsigned char)*q - '0') >= 10))
+				{
+					// ids de um dígito, os mais comuns, dispensam o from_chars
+					if (q < e && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n')
+					{
+						c.p = p;
+						return c.fail(err, "esperado um número, achou \"" + std::string(c.token()) + "\"");
+					}
+				}
+				else
+				{
+					int iv;
+					c.p = p;
+					if (!c.readInt(iv, err))
+						return false;
+					if (iv < 0 || iv > 255)
+						return c.fail(err, "id de tile fora de 0..255 na matriz: " + std::to_string(iv));
+					v = (unsigned)iv;
+					q = c.p;
+				}
+				if (out)
+				{
+					if (n == total)
+					{
+						c.p = p;
+						return c.fail(err, "a matriz passa de rows*columns (" + std::to_string(total) + ") ids");
+					}
+					out[n] = (unsigned char)v;
+				}
+				else
+					tiles.push_back((unsigned char)v);
+				n++;
+				p = q;
+			}
+			c.p = p;
+			count = n;
+		}
+		else if (section == FILE_NAME)
+		{
+			if (filled[section])
+				return c.fail(err, "[file] deve ter um valor só");
+			cfg.tilesetFile.assign(c.restOfLine());
+			filled[section] = true;
+		}
+		else
+		{
+			if (filled[section])
+				return c.fail(err, "[" + std::string(names[section]) + "] deve ter um valor só");
+			if (!c.readInt(*values[section], err))
+				return false;
+			c.skipBlanks();
+			if (!c.atLineEnd())
+				return c.fail(err, "[" + std::string(names[section]) + "] deve ter um valor só");
+			filled[section] = true;
+		}
+		c.nextLine();
+	}
+
+	for (int s = 0; s < SECTIONS; s++)
+		if (!seen[s])
+		{
+			err = path + ": seção [" + names[s] + "] ausente";
+			return false;
+		}
+
+	if (cfg.rows <= 0 || cfg.cols <= 0)
+	{
+		err = path + ": Rows/Columns inválidos";
+		return false;
+	}
+
+	if ((long long)count != (long long)cfg.rows * cfg.cols)
+	{
+		err = path + ":" + std::to_string(matrixLine) + ": tamanho da matriz (" + std::to_string(count) +
+			  ") difere de rows*columns (" + std::to_string((long long)cfg.rows * cfg.cols) + ")";
+		return false;
+	}
+
+	cfg.binario.close();
+	cfg.matrixTexto.swap(tiles);
+	cfg.matrix = cfg.matrixTexto.data();
+
+	if (cfg.playerInicialRow < 0 || cfg.playerInicialRow >= cfg.rows ||
+		cfg.playerInicialCol < 0 || cfg.playerInicialCol >= cfg.cols)
+	{
+		err = path + ": posição inicial fora da matriz";
+		return false;
+	}
+
+	return true;
+}
+
+// Lê o config/tileProps.txt: [walkable], [deadly], [blocked] e [coin] (sem
+// diferenciar maiúsculas) com ids de tile; linhas com # são comentários e
+// seções desconhecidas são ignoradas. Ids fora de tileTypes só geram aviso.
+inline bool loadTileProps(const std::string &filename, std::vector<TileType> &tileTypes, std::string &err)
+{
+	MappedFile file;
+	const char *begin, *end;
+	if (!openConfig(filename, file, begin, end, err))
+		return false;
+
+	static const char *names[] = {"walkable", "deadly", "blocked", "coin"};
+	static const TileType types[] = {TileType::Walkable, TileType::Deadly, TileType::Blocked, TileType::Coin};
+
+	ConfigCursor c(begin, end, filename);
+	int section = -1;
+	while (c.p < c.end)
+	{
+		c.skipBlanks();
+		if (c.atLineEnd() || *c.p == '#')
+		{
+			c.nextLine();
+			continue;
+		}
+
+		if (*c.p == '[')
+		{
+			std::string_view name;
+			if (!c.readSection(name, err))
+				return false;
+			section = -1;
+			for (int s = 0; s < 4 && section < 0; s++)
+			{
+				size_t n = strlen(names[s]), k = 0;
+				while (k < n && k < name.size() && tolower((unsigned char)name[k]) == names[s][k])
+					k++;
+				if (k == n && n == name.size())
+					section = s;
+			}
+			c.nextLine();
+			continue;
+		}
+
+		if (section < 0)
+		{
+			c.nextLine();
+			continue;
+		}
+		while (true)
+		{
+			c.skipBlanks();
+			if (c.atLineEnd())
+				break;
+			int tileID;
+			if (!c.readInt(tileID, err))
+				return false;
+			if (tileID >= 0 && tileID < (int)tileTypes.size())
+				tileTypes[tileID] = types[section];
+			else
+				std::cerr << filename << ":" << c.line << ": ID de tile inválido: " << tileID << std::endl;
+		}
+		c.nextLine();
+	}
+
+	return true;
+}
+
+inline TileType tileTypeFromProp(unsigned char prop)
+{
+	switch (prop)
+	{
+	case TILE_PROP_WALKABLE:
+		return TileType::Walkable;
+	case TILE_PROP_DEADLY:
+		return TileType::Deadly;
+	case TILE_PROP_BLOCKED:
+		return TileType::Blocked;
+	case TILE_PROP_COIN:
+		return TileType::Coin;
+	default:
+		return TileType::Unknown;
+	}
+}
+
+inline unsigned char tileTypeToProp(TileType type)
+{
+	switch (type)
+	{
+	case TileType::Walkable:
+		return TILE_PROP_WALKABLE;
+	case TileType::Deadly:
+		return TILE_PROP_DEADLY;
+	case TileType::Blocked:
+		return TILE_PROP_BLOCKED;
+	case TileType::Coin:
+		return TILE_PROP_COIN;
+	default:
+		return TILE_PROP_UNKNOWN;
+	}
+}
+
+// Abre o .tbin: cfg.matrix passa a apontar para dentro do arquivo mapeado
+inline bool loadMapBinary(const std::string &path, MapConfig &cfg, std::vector<TileType> &tileTypes, std::string &err)
+{
+	if (!cfg.binario.open(path, err))
+		return false;
+
+	const BinaryMapHeader &h = cfg.binario.getHeader();
+	cfg.tilesetFile = std::string(h.tileset, strnlen(h.tileset, sizeof(h.tileset)));
+	cfg.nTiles = h.nTiles;
+	cfg.tileW = h.tileW;
+	cfg.tileH = h.tileH;
+	cfg.rows = h.rows;
+	cfg.cols = h.cols;
+	cfg.playerInicialRow = h.startRow;
+	cfg.playerInicialCol = h.startCol;
+	cfg.matrix = cfg.binario.getTiles();
+	std::vector<unsigned char>().swap(cfg.matrixTexto);
+
+	tileTypes.resize(cfg.nTiles);
+	for (int i = 0; i < cfg.nTiles; i++)
+		tileTypes[i] = tileTypeFromProp(cfg.binario.getProps()[i]);
+
+	if (cfg.playerInicialRow < 0 || cfg.playerInicialRow >= cfg.rows ||
+		cfg.playerInicialCol < 0 || cfg.playerInicialCol >= cfg.cols)
+	{
+		err = "Posição inicial fora da matriz";
+		cfg.binario.close();
+		return false;
+	}
+	return true;
+}
+
+inline bool saveMapBinary(const std::string &path, const MapConfig &cfg, const std::vector<TileType> &tileTypes, std::string &err)
+{
+	if (cfg.tilesetFile.size() >= sizeof(BinaryMapHeader::tileset))
+	{
+		err = "Nome do tileset longo demais para o .tbin: " + cfg.tilesetFile;
+		return false;
+	}
+
+	BinaryMapHeader h;
+	memset(&h, 0, sizeof(h));
+	h.cols = cfg.cols;
+	h.rows = cfg.rows;
+	h.tileW = cfg.tileW;
+	h.tileH = cfg.tileH;
+	h.nTiles = (int32_t)tileTypes.size();
+	h.startRow = cfg.playerInicialRow;
+	h.startCol = cfg.playerInicialCol;
+	memcpy(h.tileset, cfg.tilesetFile.c_str(), cfg.tilesetFile.size());
+
+	std::vector<unsigned char> props(tileTypes.size());
+	for (size_t i = 0; i < tileTypes.size(); i++)
+		props[i] = tileTypeToProp(tileTypes[i]);
+
+	return BinaryMap::write(path, h, cfg.matrix, props.data(), err);
+}
+
+// Usa o .tbin se ele existir e não for mais antigo que os textos; senão lê os textos.
+inline bool loadMap(const std::string &mapPath, const std::string &propsPath, const std::string &binPath,
+					MapConfig &cfg, std::vector<TileType> &tileTypes, std::string &err)
+{
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	fs::file_time_type binTime = fs::last_write_time(binPath, ec);
+	if (!ec && binTime >= fs::last_write_time(mapPath, ec) && binTime >= fs::last_write_time(propsPath, ec))
+	{
+		if (loadMapBinary(binPath, cfg, tileTypes, err))
+			return true;
+		std::cerr << "Aviso: " << err << "; lendo " << mapPath << std::endl;
+	}
+
+	if (!loadMapConfig(mapPath, cfg, err))
+		return false;
+	tileTypes.assign(cfg.nTiles, TileType::Unknown);
+	return loadTileProps(propsPath, tileTypes, err);
+}
+
+#endif
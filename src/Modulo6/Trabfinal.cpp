@@ -2,8 +2,10 @@
 #include <sstream>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <iostream>
 #include <string>
+#include <ctime>
 #include <windows.h>
 
 #include <glad/glad.h>
@@ -11,23 +13,27 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "AssetLoader.h"
+#include "ChunkedTileMap.h"
+#include "FrameProfiler.h"
+#include "Headless.h"
+#include "IsometricView.h"
+#include "Jogo.h"
+#include "MapConfig.h"
+#include "ShaderProgram.h"
+#include "SpriteAnimator.h"
+#include "TextureAtlas.h"
+
 using namespace std;
 using namespace glm;
 
-enum class TileType
-{
-	Walkable,
-	Deadly,
-	Blocked,
-	Unknown,
-	Coin,
-};
-
 struct Sprite
 {
 	GLuint VAO;
@@ -35,6 +41,7 @@ struct Sprite
 	vec3 position;
 	vec3 dimensions;
 	float ds, dt;
+	float s0, t0; // offsetTex do quadro 0 dentro do atlas
 	int iAnimation, iFrame;
 	int nAnimations, nFrames;
 };
@@ -47,47 +54,52 @@ struct Tile
 	vec3 position;
 	vec3 dimensions;
 	float ds, dt;
+	float s0, t0; // offsetTex do tile 0 dentro do atlas
 	TileType type = TileType::Unknown;
 };
 
-struct MapConfig
-{
-	string tilesetFile;
-	int nTiles;
-	int tileW, tileH;
-	int rows, cols;
-	vector<int> matrix;
-	int playerInicialRow, playerInicialCol;
-};
-
-struct Coin
-{
-	int i, j;		// Posição no tile
-	bool collected; // Verifica se foi coletada ou não
-	GLuint texID;
-};
-
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
-bool loadMapConfig(const string &path, MapConfig &cfg, string &err);
-bool loadTileProps(const string &filename, vector<TileType> &tileTypes);
 int setupShader();
-int setupSprite(int nAnimations, int nFrames, float &ds, float &dt);
-int setupTile(int nTiles, float &ds, float &dt);
-int loadTexture(string filePath, int &width, int &height);
-void desenharMapa(GLuint shaderID, float x0, float y0);
-void inicializarMoedas(GLuint texCoin);
-void desenharMoedas(GLuint shaderID, float x0, float y0, const vector<Coin> &moedas);
+int setupSprite(int nAnimations, int nFrames, const AtlasRegion &r, float &ds, float &dt);
+int setupTile(int nTiles, const AtlasRegion &r, float &ds, float &dt);
+void origemNoAtlas(const AtlasRegion &r, float dt, float &s0, float &t0);
+void pedirAtlas(AssetLoader &carregador, const string &folhaJogador);
+bool esperarAtlas(GLFWwindow *window, AssetLoader &carregador, const string &folhaJogador);
+void construirMapaVisual(float x0, float y0);
+void desenharMapa(ShaderProgram &programa, vector<TileSpan> &visiveis);
+void desenharMapaPorTile(ShaderProgram &programa, float x0, float y0);
+void desenharMoedas(ShaderProgram &programa, float x0, float y0, const vector<Moeda> &moedas);
 
 MapConfig cfg;
 vector<Tile> tileset;
-int player_i = 0, player_j = 0;
+
+// Tileset, moeda e jogador numa textura só: o quadro não troca de textura entre eles
+TextureAtlas *atlas = NULL;
+Sprite spriteMoeda;
+int atlasFaltando = 0; // imagens do atlas ainda não entregues pelo AssetLoader
+bool atlasFalhou = false;
+
+inline int tileAt(int i, int j) { return cfg.matrix[i * cfg.cols + j]; }
+
+// Aparência do mapa na GPU, em chunks (coluna = j, linha = i).
+// Difere de cfg.matrix só no tile de destaque sob o jogador.
+IsometricView isoView;
+ChunkedTileMap *mapaVisual = NULL;
+float mapaX0, mapaY0; // origem do mapa na tela
 GLuint WIDTH = 800, HEIGHT = 600;
 
-vector<Coin> moedas;
-int pontuacao = 0;
-int totalMoedas = 0;
-int vida = 3;
+// Regras e estado da partida (ver Jogo.h): as teclas viram comandos para ele
+Jogo *jogo = NULL;
+uint32_t semente;
+vector<Comando> gravacao; // comandos da partida, gravados no fim com --gravar
+
+// Tecla M alterna entre a malha única e o desenho antigo (um glDrawArrays por tile),
+// para comparar o tempo de quadro dos dois caminhos.
+bool mapaPorTile = false;
+
+// Slots das uniforms enviadas a cada objeto desenhado, buscados uma vez (ver ShaderProgram.h)
+int uModel = -1, uOffsetTex = -1;
 
 const GLchar *vertexShaderSource = R"(
  #version 400
@@ -116,34 +128,84 @@ const GLchar *fragmentShaderSource = R"(
  }
  )";
 
-int main()
+// Sem argumentos abre a janela do jogo. Com --headless N desenha N quadros num
+// FBO, sem janela visível, e mostra os tempos de quadro (ver Headless.h), ex.:
+//   Trabfinal --headless 600 --timings tempos.csv --capture quadro
+// --semente N fixa o sorteio das moedas, --moedas N muda o máximo de moedas
+// (padrão 15) e --gravar arq.txt grava os comandos da partida, que
+// Ferramentas/ReplayJogo reproduz sem janela. --perfil arq.json grava os
+// tempos por zona dos últimos quadros (ver FrameProfiler.h), para abrir no
+// chrome://tracing ou no ui.perfetto.dev.
+int main(int argc, char **argv)
 {
-	srand(glfwGetTime());
+	semente = (uint32_t)time(NULL);
+	string arquivoGravacao, arquivoPerfil;
+	int maxMoedas = Jogo::MAX_MOEDAS;
+	vector<char *> outrosArgs(1, argv[0]);
+	for (int i = 1; i < argc; i++)
+	{
+		if (string(argv[i]) == "--semente" && i + 1 < argc)
+			semente = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (string(argv[i]) == "--moedas" && i + 1 < argc)
+			maxMoedas = atoi(argv[++i]);
+		else if (string(argv[i]) == "--gravar" && i + 1 < argc)
+			arquivoGravacao = argv[++i];
+		else if (string(argv[i]) == "--perfil" && i + 1 < argc)
+			arquivoPerfil = argv[++i];
+		else
+			outrosArgs.push_back(argv[i]);
+	}
+
+	HeadlessOptions headless;
+	if (!headless.parseArgs((int)outrosArgs.size(), outrosArgs.data()))
+		return -1;
 
+	// config/tileMap.tbin (gerado pelo ConverteMapa) é mapeado direto; sem ele, lê os .txt
 	string err;
-	if (!loadMapConfig("../src/Modulo6/config/tileMap.txt", cfg, err))
+	vector<TileType> tileTypes;
+	if (!loadMap("../src/Modulo6/config/tileMap.txt", "../src/Modulo6/config/tileProps.txt",
+				 "../src/Modulo6/config/tileMap.tbin", cfg, tileTypes, err))
 	{
 		cerr << "Erro: " << err << '\n';
 		return -1;
 	}
 
+	// Quadros do jogador: clipes em config/animacoes.txt (ver SpriteAnimator.h)
+	vector<AnimationClip> clipes;
+	if (!loadAnimationClips("../src/Modulo6/config/animacoes.txt", clipes, err))
+	{
+		cerr << "Erro: " << err << '\n';
+		return -1;
+	}
+	SpriteAnimator animador(clipes);
+	int clipePulo = animador.findClip("pulo");
+	if (clipePulo < 0)
+	{
+		cerr << "Erro: clipe \"pulo\" ausente em config/animacoes.txt" << '\n';
+		return -1;
+	}
+
 	WIDTH = ((cfg.rows + cfg.cols) / 2) * cfg.tileW + 20;
 	HEIGHT = ((cfg.rows + cfg.cols) / 2) * cfg.tileH + 20;
 	float x0 = (cfg.rows - 1) * cfg.tileW * 0.5f;
 	float y0 = 10.0f;
 
-	player_i = cfg.playerInicialRow;
-	player_j = cfg.playerInicialCol;
+	jogo = new Jogo(cfg, tileTypes, maxMoedas);
+	jogo->reiniciar(semente);
+
+	// As imagens do atlas são decodificadas em outras threads enquanto a janela,
+	// o contexto e o shader são criados
+	AssetLoader *carregador = new AssetLoader();
+	// A folha do jogador é a do clipe de pulo (coluna "folha" de config/animacoes.txt)
+	const string &folhaJogador = animador.getClip(clipePulo).sheet;
+	pedirAtlas(*carregador, folhaJogador);
 
-	vector<TileType> tileTypes(cfg.nTiles, TileType::Unknown);
-	if (!loadTileProps("../src/Modulo6/config/tileProps.txt", tileTypes))
+	if (headless.enabled ? !glfwInitHeadless() : !glfwInit())
 	{
-		cerr << "Erro ao carregar propriedades dos tiles!" << endl;
+		std::cerr << "Falha ao inicializar a GLFW" << std::endl;
 		return -1;
 	}
 
-	glfwInit();
-
 	glfwWindowHint(GLFW_SAMPLES, 8);
 
 	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Vivencial 3", nullptr, nullptr);
@@ -174,11 +236,18 @@ int main()
 	glViewport(0, 0, width, height);
 
 	GLuint shaderID = setupShader();
+	ShaderProgram programa(shaderID); // uniforms lidas uma vez; envios repetidos são pulados
 
-	int imgWidth, imgHeight;
-
-	GLuint texID = loadTexture("../assets/tilesets/tilesetIso.png", imgWidth, imgHeight);
-	GLuint texCoin = loadTexture("../assets/sprites/coin.png", imgWidth, imgHeight);
+	bool atlasOk = esperarAtlas(window, *carregador, folhaJogador);
+	delete carregador;
+	if (!atlasOk)
+	{
+		cerr << "Erro ao montar o atlas de texturas!" << endl;
+		return -1;
+	}
+	const AtlasRegion &regiaoTiles = *atlas->find(cfg.tilesetFile.substr(0, cfg.tilesetFile.rfind('.')));
+	const AtlasRegion &regiaoMoeda = *atlas->find("coin");
+	const AtlasRegion &regiaoJogador = *atlas->find(folhaJogador);
 
 	for (int i = 0; i < cfg.nTiles; ++i)
 	{
@@ -186,12 +255,24 @@ int main()
 		tile.dimensions = vec3(cfg.tileW, cfg.tileH, 1.0);
 		tile.iTile = i;
 		tile.type = tileTypes[i];
-		tile.texID = texID;
-		tile.VAO = setupTile(cfg.nTiles, tile.ds, tile.dt);
+		tile.texID = atlas->getTexture(regiaoTiles);
+		tile.VAO = setupTile(cfg.nTiles, regiaoTiles, tile.ds, tile.dt);
+		origemNoAtlas(regiaoTiles, tile.dt, tile.s0, tile.t0);
 		tileset.push_back(tile);
 	}
 
-	glUseProgram(shaderID);
+	spriteMoeda.texID = atlas->getTexture(regiaoMoeda);
+	spriteMoeda.VAO = setupSprite(1, 1, regiaoMoeda, spriteMoeda.ds, spriteMoeda.dt); // Uma sprite estática (1x1)
+	origemNoAtlas(regiaoMoeda, spriteMoeda.dt, spriteMoeda.s0, spriteMoeda.t0);
+
+	// O tile sob o jogador é desenhado com o tile 6 (destaque)
+	construirMapaVisual(x0, y0);
+	int destaque_i = cfg.playerInicialRow, destaque_j = cfg.playerInicialCol;
+	mapaVisual->setTile(destaque_j, destaque_i, 6);
+
+	programa.use();
+	uModel = programa.slot("model");
+	uOffsetTex = programa.slot("offsetTex");
 
 	double prev_s = glfwGetTime();
 	double title_countdown_s = 0.1;
@@ -200,10 +281,10 @@ int main()
 
 	glActiveTexture(GL_TEXTURE0);
 
-	glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+	programa.setInt("tex_buff", 0);
 
 	mat4 projection = ortho(0.0f, (float)WIDTH, (float)HEIGHT, 0.0f, -1.0f, 1.0f);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	programa.setMat4("projection", value_ptr(projection));
 
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_ALWAYS);
@@ -211,24 +292,46 @@ int main()
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+	// A grade da folha (linhas x colunas) vem do clipe
+	const AnimationClip &pulo = animador.getClip(clipePulo);
 	Sprite jogador;
 	jogador.dimensions = vec3(cfg.tileW, cfg.tileW, 1.0); // altura da sprite, ajustável
-	jogador.texID = loadTexture("../assets/sprites/Jump.png", imgWidth, imgHeight);
-	jogador.VAO = setupSprite(1, 15, jogador.ds, jogador.dt); // 1 linha, 15 sprites
-	jogador.nAnimations = 1;
-	jogador.nFrames = 15;
-	jogador.iAnimation = 0;
-	jogador.iFrame = 6; // começando do sprite 6 ao 12
-
-	double tempo_animacao = 0;
-	int frame_atual = 6;
+	jogador.texID = atlas->getTexture(regiaoJogador);
+	jogador.VAO = setupSprite(pulo.rows, pulo.cols, regiaoJogador, jogador.ds, jogador.dt);
+	origemNoAtlas(regiaoJogador, jogador.dt, jogador.s0, jogador.t0);
+	jogador.nAnimations = pulo.rows;
+	jogador.nFrames = pulo.cols;
+	int atorJogador = animador.add(clipePulo);
 
 	double lastTime = glfwGetTime();
 	double deltaT = 0.0;
-	inicializarMoedas(texCoin);
 
-	while (!glfwWindowShouldClose(window))
+	double tempoQuadros = 0.0;
+	int nQuadros = 0;
+
+	// Sem janela: desenha no FBO, sem vsync, e com passo de tempo fixo para
+	// que as capturas de uma execução para outra sejam iguais
+	HeadlessRun *execucao = NULL;
+	if (headless.enabled)
+	{
+		glfwSwapInterval(0);
+		execucao = new HeadlessRun(headless);
+		if (!execucao->start(WIDTH, HEIGHT))
+			return -1;
+	}
+
+	// Tempo de CPU e GPU por zona do quadro. Sem janela, o HeadlessRun já mede
+	// o quadro inteiro com GL_TIME_ELAPSED, e essas consultas não se sobrepõem.
+	FrameProfiler *perfil = new FrameProfiler();
+	if (execucao)
+		perfil->setGpuEnabled(false);
+
+	vector<TileSpan> visiveis; // chunks visíveis do quadro; a capacidade fica para o próximo
+	while (!glfwWindowShouldClose(window) && !(execucao && execucao->done()))
 	{
+		perfil->beginFrame();
+		const EstadoJogo &estado = jogo->estado();
+
 		{
 			double curr_s = glfwGetTime();
 			double elapsed_s = curr_s - prev_s;
@@ -241,13 +344,19 @@ int main()
 
 				char tmp[256];
 				// Adicione a pontuação ao formato da string
-				sprintf(tmp, "PG - Grau B - Amanda Vidal, Lucas Essvein e Marcos Krol\tVida: %d\tScore: %d\t", vida, pontuacao);
+				sprintf(tmp, "PG - Grau B - Amanda Vidal, Lucas Essvein e Marcos Krol\tVida: %d\tScore: %d\t", estado.vida, estado.pontuacao);
 				glfwSetWindowTitle(window, tmp);
 				title_countdown_s = 0.1;
 			}
 		}
 
-		glfwPollEvents();
+		{
+			ProfileZone zona(*perfil, "entrada");
+			glfwPollEvents();
+		}
+
+		if (execucao)
+			execucao->beginFrame();
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -256,153 +365,146 @@ int main()
 		glPointSize(20);
 
 		double currTime = glfwGetTime();
-		deltaT = currTime - lastTime;
+		deltaT = execucao ? 1.0 / 60.0 : currTime - lastTime;
 		lastTime = currTime;
 
-		tempo_animacao += deltaT;
-		if (tempo_animacao > 0.1) // troca de frame a cada 0.1s
+		animador.update((float)deltaT);
+		jogador.iFrame = animador.getColumn()[atorJogador];
+		jogador.iAnimation = animador.getRow()[atorJogador];
+
+		tempoQuadros += deltaT;
+		if (++nQuadros == 300)
 		{
-			frame_atual++;
-			if (frame_atual > 12)
-				frame_atual = 6; // loop do 6 ao 12
-			jogador.iFrame = frame_atual;
-			tempo_animacao = 0;
+			// Sem janela deltaT é fixo em 1/60 s; os tempos reais saem em execucao->finish()
+			if (!execucao)
+				cout << "Mapa (" << (mapaPorTile ? "por tile" : "chunks") << "): "
+					 << tempoQuadros / nQuadros * 1000.0 << " ms/quadro" << endl;
+			// Sem a tabela, cada busca seria um glGetUniformLocation e cada envio pulado um glUniform*
+			cout << "Uniforms por quadro: " << programa.uploads / nQuadros << " enviadas, "
+				 << programa.skipped / nQuadros << " repetidas evitadas, "
+				 << programa.lookups / nQuadros << " glGetUniformLocation evitados" << endl;
+			programa.resetStats();
+			perfil->report(nQuadros);
+			tempoQuadros = 0.0;
+			nQuadros = 0;
 		}
 
-		desenharMapa(shaderID, x0, y0);
-		desenharMoedas(shaderID, x0, y0, moedas);
+		// Só os chunks dos tiles que mudaram são reenviados
+		if (destaque_i != estado.player_i || destaque_j != estado.player_j)
+		{
+			mapaVisual->setTile(destaque_j, destaque_i, tileAt(destaque_i, destaque_j));
+			mapaVisual->setTile(estado.player_j, estado.player_i, 6);
+			destaque_i = estado.player_i;
+			destaque_j = estado.player_j;
+		}
 
-		Tile curr_tile = tileset[cfg.matrix[player_i * cfg.cols + player_j]];
+		{
+			ProfileZone zona(*perfil, "mapa", true);
+			if (mapaPorTile)
+				desenharMapaPorTile(programa, x0, y0);
+			else
+				desenharMapa(programa, visiveis);
+		}
+		{
+			ProfileZone zona(*perfil, "moedas", true);
+			desenharMoedas(programa, x0, y0, estado.moedas);
+		}
 
-		float x = x0 + (player_j - player_i) * curr_tile.dimensions.x / 2.0f;
-		float y = y0 + (player_j + player_i) * curr_tile.dimensions.y / 2.0f;
+		const Tile &curr_tile = tileset[tileAt(estado.player_i, estado.player_j)];
+
+		float x = x0 + (estado.player_j - estado.player_i) * curr_tile.dimensions.x / 2.0f;
+		float y = y0 + (estado.player_j + estado.player_i) * curr_tile.dimensions.y / 2.0f;
 
 		mat4 model = mat4(1.0);
 		model = translate(model, vec3(x + curr_tile.dimensions.x / 2.0, y + curr_tile.dimensions.y / 2.0 - jogador.dimensions.y / 2.0, 0));
 		model = scale(model, jogador.dimensions);
 
-		glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+		programa.setMat4(uModel, value_ptr(model));
 
 		vec2 offsetTex;
-		offsetTex.s = jogador.iFrame * jogador.ds;
-		offsetTex.t = 1.0 - jogador.dt;
-		glUniform2f(glGetUniformLocation(shaderID, "offsetTex"), offsetTex.s, offsetTex.t);
+		offsetTex.s = jogador.s0 + jogador.iFrame * jogador.ds;
+		offsetTex.t = jogador.t0 + jogador.iAnimation * jogador.dt;
+		programa.setVec2(uOffsetTex, offsetTex.s, offsetTex.t);
 
 		glBindVertexArray(jogador.VAO);
 		glBindTexture(GL_TEXTURE_2D, jogador.texID);
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-		// Verifica se a moeda foi coletada e adiciona pontuação
-		for (auto &moeda : moedas)
-		{
-			if (!moeda.collected && moeda.i == player_i && moeda.j == player_j)
-			{
-				moeda.collected = true;
-				pontuacao++;
-				std::cout << "Moeda coletada! Pontuação: " << pontuacao << std::endl;
-			}
-		}
-
-		// Verifica a pontuação com o total de moedas coledas e emite mensagem de ganhador
-		if (pontuacao == totalMoedas && totalMoedas > 0)
 		{
-			std::cout << "Parabéns! Você conseguiu coletar todas as moedas e ganhou o jogo." << std::endl;
-			std::cout << "Moedas coletadas: " << totalMoedas << std::endl;
-			glfwSetWindowShouldClose(window, GL_TRUE);
+			ProfileZone zona(*perfil, "troca");
+			if (execucao)
+				execucao->endFrame();
+			else
+				glfwSwapBuffers(window);
 		}
+		perfil->endFrame();
+	}
 
-		glfwSwapBuffers(window);
+	int retorno = 0;
+	if (execucao)
+	{
+		retorno = execucao->finish() ? 0 : -1;
+		delete execucao;
 	}
 
+	if (!arquivoGravacao.empty() && !gravarGravacao(arquivoGravacao, semente, maxMoedas, gravacao))
+		cerr << "Erro ao gravar " << arquivoGravacao << endl;
+	if (!arquivoPerfil.empty() && !perfil->writeChromeTrace(arquivoPerfil))
+		cerr << "Erro ao gravar " << arquivoPerfil << endl;
+
+	delete perfil;
+	delete jogo;
+	delete mapaVisual;
+	delete atlas;
 	glfwTerminate();
-	return 0;
+	return retorno;
 }
 
-inline int tileAt(int i, int j) { return cfg.matrix[i * cfg.cols + j]; }
-
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 
-	if (action == GLFW_PRESS)
+	if (key == GLFW_KEY_M && action == GLFW_PRESS)
 	{
-		int di = 0, dj = 0;
-
-		switch (key)
-		{
-		case GLFW_KEY_Z:
-			di = +1;
-			dj = -1;
-			break; // SW
-		case GLFW_KEY_X:
-			di = +1;
-			dj = 0;
-			break; // S
-		case GLFW_KEY_C:
-			di = +1;
-			dj = +1;
-			break; // SE
-		case GLFW_KEY_A:
-			di = 0;
-			dj = -1;
-			break; // W
-		case GLFW_KEY_D:
-			di = 0;
-			dj = +1;
-			break; // E
-		case GLFW_KEY_Q:
-			di = -1;
-			dj = -1;
-			break; // NW
-		case GLFW_KEY_W:
-			di = -1;
-			dj = 0;
-			break; // N
-		case GLFW_KEY_E:
-			di = -1;
-			dj = +1;
-			break; // NE
-		}
+		mapaPorTile = !mapaPorTile;
+		glfwSwapInterval(0); // sem vsync, para o tempo de quadro refletir o custo de desenho
+		cout << "Desenho do mapa: " << (mapaPorTile ? "por tile" : "chunks") << endl;
+		return;
+	}
 
-		int new_i = player_i + di;
-		int new_j = player_j + dj;
+	if (action != GLFW_PRESS || key < GLFW_KEY_A || key > GLFW_KEY_Z)
+		return;
+	Comando comando = comandoDaTecla((char)('A' + key - GLFW_KEY_A));
+	if (comando == Comando::Nenhum || jogo->estado().fim)
+		return;
 
-		if (new_i >= 0 && new_j >= 0 && new_i < cfg.rows && new_j < cfg.cols)
-		{
-			int tileID = tileAt(new_i, new_j);
-			TileType tileType = tileset[tileID].type;
+	gravacao.push_back(comando);
+	unsigned eventos = jogo->passo(comando);
+	const EstadoJogo &estado = jogo->estado();
 
-			switch (tileType)
-			{
-			case TileType::Walkable:
-				player_i = new_i;
-				player_j = new_j;
-				break;
-			case TileType::Deadly:
-				// Como visitou um tile perigoso, ele perde uma vida.
-				player_i = cfg.playerInicialCol;
-				player_j = cfg.playerInicialRow;
-				cout << "Você pisou em um tile perigoso! Perdeu 1 vida." << endl;
-				vida--;
-				cout << "Vidas: " << vida << endl;
-				break;
-			case TileType::Blocked:
-				cout << "Tile bloqueado! Não é possível se mover para cá." << endl;
-				break;
-			case TileType::Unknown:
-			default:
-				cout << "Tile desconhecido! Não é possível se mover para cá." << endl;
-				break;
-			}
-		}
-
-		// Se a vida for menor ou igual a 0, o jogo encerra.
-		if (vida <= 0)
-		{
-			cout << "Game over! Sua vida chegou a zero." << endl;
-			glfwSetWindowShouldClose(window, GL_TRUE);
-		}
+	if (eventos & EVENTO_MORREU)
+	{
+		cout << "Você pisou em um tile perigoso! Perdeu 1 vida." << endl;
+		cout << "Vidas: " << estado.vida << endl;
+	}
+	if (eventos & EVENTO_BLOQUEADO)
+		cout << "Tile bloqueado! Não é possível se mover para cá." << endl;
+	if (eventos & EVENTO_DESCONHECIDO)
+		cout << "Tile desconhecido! Não é possível se mover para cá." << endl;
+	if (eventos & EVENTO_MOEDA)
+		cout << "Moeda coletada! Pontuação: " << estado.pontuacao << endl;
+
+	if (eventos & EVENTO_PERDEU)
+	{
+		cout << "Game over! Sua vida chegou a zero." << endl;
+		glfwSetWindowShouldClose(window, GL_TRUE);
+	}
+	if (eventos & EVENTO_VENCEU)
+	{
+		cout << "Parabéns! Você conseguiu coletar todas as moedas e ganhou o jogo." << endl;
+		cout << "Moedas coletadas: " << estado.totalMoedas << endl;
+		glfwSetWindowShouldClose(window, GL_TRUE);
 	}
 }
 
@@ -447,11 +549,11 @@ int setupShader()
 	return shaderProgram;
 }
 
-int setupSprite(int nAnimations, int nFrames, float &ds, float &dt)
+int setupSprite(int nAnimations, int nFrames, const AtlasRegion &r, float &ds, float &dt)
 {
 
-	ds = 1.0 / (float)nFrames;
-	dt = 1.0 / (float)nAnimations;
+	ds = (r.u1 - r.u0) / (float)nFrames;
+	dt = (r.v1 - r.v0) / (float)nAnimations;
 
 	GLfloat vertices[] = {
 		-0.5, 0.5, 0.0, 0.0, 0.0,
@@ -481,11 +583,11 @@ int setupSprite(int nAnimations, int nFrames, float &ds, float &dt)
 	return VAO;
 }
 
-int setupTile(int nTiles, float &ds, float &dt)
+int setupTile(int nTiles, const AtlasRegion &r, float &ds, float &dt)
 {
 
-	ds = 1.0 / (float)nTiles;
-	dt = 1.0;
+	ds = (r.u1 - r.u0) / (float)nTiles;
+	dt = r.v1 - r.v0;
 
 	float th = 1.0, tw = 1.0;
 
@@ -517,48 +619,118 @@ int setupTile(int nTiles, float &ds, float &dt)
 	return VAO;
 }
 
-int loadTexture(string filePath, int &width, int &height)
+// O shader usa (s, 1 - t) + offsetTex. Para o quadro 0 de r cair no lugar certo
+// (primeira linha de altura dt do retângulo), offsetTex deve valer (s0, t0).
+void origemNoAtlas(const AtlasRegion &r, float dt, float &s0, float &t0)
 {
-	GLuint texID;
-
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-	int nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
+	s0 = r.u0;
+	t0 = r.v0 + dt - 1.0f;
+}
 
-	if (data)
+// Usa o atlas gerado offline (Ferramentas/GeraAtlas) se existir: as páginas vão
+// direto para texturas. Senão, recebe os pixels só das imagens que o jogo usa e
+// empacota o atlas quando a última chega. Os callbacks rodam em esperarAtlas().
+void pedirAtlas(AssetLoader &carregador, const string &folhaJogador)
+{
+	atlas = new TextureAtlas();
+	vector<string> paginas;
+	if (atlas->loadTable("../assets/atlas", paginas))
 	{
-		if (nrChannels == 3)
+		atlasFaltando = (int)paginas.size();
+		for (size_t p = 0; p < paginas.size(); p++)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+			auto recebePagina = [p](GLuint tid, int w, int h)
+			{
+				if (tid)
+					atlas->setPageTexture((int)p, tid, w, h);
+				else
+					atlasFalhou = true;
+				atlasFaltando--;
+			};
+			carregador.loadTexture(paginas[p], recebePagina);
 		}
-		else
+		return;
+	}
+
+	string nomeTileset = cfg.tilesetFile.substr(0, cfg.tilesetFile.rfind('.'));
+	vector<pair<string, string>> imagens = {
+		{nomeTileset, "../assets/tilesets/" + cfg.tilesetFile},
+		{"coin", "../assets/sprites/coin.png"},
+		{folhaJogador, "../assets/sprites/" + folhaJogador + ".png"}};
+	atlasFaltando = (int)imagens.size();
+	for (const auto &imagem : imagens)
+	{
+		string nome = imagem.first;
+		auto recebeImagem = [nome](const unsigned char *rgba, int w, int h)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
+			if (rgba)
+				atlas->add(nome, rgba, w, h);
+			else
+				atlasFalhou = true;
+			if (--atlasFaltando == 0 && !atlasFalhou)
+			{
+				if (atlas->pack())
+					atlas->upload(GL_NEAREST);
+				else
+					atlasFalhou = true;
+			}
+		};
+		carregador.loadPixels(imagem.second, recebeImagem);
 	}
-	else
+}
+
+// Enquanto o atlas não chega, a janela continua respondendo: a cada quadro o
+// carregador envia à GPU só o que couber em 4 ms
+bool esperarAtlas(GLFWwindow *window, AssetLoader &carregador, const string &folhaJogador)
+{
+	double inicio = glfwGetTime();
+	while (atlasFaltando > 0 && !atlasFalhou && !glfwWindowShouldClose(window))
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		glfwPollEvents();
+		carregador.update(4.0);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glfwSwapBuffers(window);
 	}
+	if (atlasFaltando > 0 || atlasFalhou)
+		return false;
+	cout << "Atlas pronto em " << (glfwGetTime() - inicio) * 1000.0 << " ms após o contexto" << endl;
 
-	stbi_image_free(data);
+	return atlas->find(cfg.tilesetFile.substr(0, cfg.tilesetFile.rfind('.'))) &&
+		   atlas->find("coin") && atlas->find(folhaJogador);
+}
+
+void construirMapaVisual(float x0, float y0)
+{
+	mapaX0 = x0;
+	mapaY0 = y0;
+	mapaVisual = new ChunkedTileMap(cfg.cols, cfg.rows, 0);
+	mapaVisual->setTid(tileset[0].texID);
+	mapaVisual->setLayout(&isoView, cfg.tileW, cfg.tileH, x0, y0, cfg.nTiles, 1);
+	// Retângulo do tileset no atlas, espelhado em t como o shader espera:
+	// (u0, 1 - v1, u1, 1 - v0), com t0 = v1 - 1 e dt = v1 - v0 (ver origemNoAtlas)
+	const Tile &tile0 = tileset[0];
+	mapaVisual->setTilesetRect(tile0.s0, -tile0.t0, tile0.s0 + cfg.nTiles * tile0.ds, tile0.dt - tile0.t0);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	for (int i = 0; i < cfg.rows; i++)
+		for (int j = 0; j < cfg.cols; j++)
+			mapaVisual->setTile(j, i, tileAt(i, j));
+}
 
-	return texID;
+void desenharMapa(ShaderProgram &programa, vector<TileSpan> &visiveis)
+{
+	// Posições e UVs já estão nas malhas dos chunks: model identidade e sem deslocamento de textura
+	mat4 model = mat4(1);
+	programa.setMat4(uModel, value_ptr(model));
+	programa.setVec2(uOffsetTex, 0.0f, 0.0f);
+
+	// Só os chunks que aparecem na janela
+	isoView.computeVisibleSpans(cfg.tileW, cfg.tileH, -mapaX0, -mapaY0, WIDTH - mapaX0, HEIGHT - mapaY0,
+								cfg.cols, cfg.rows, visiveis);
+	mapaVisual->draw(visiveis);
 }
 
-void desenharMapa(GLuint shaderID, float x0, float y0)
+void desenharMapaPorTile(ShaderProgram &programa, float x0, float y0)
 {
 	for (int i = 0; i < cfg.rows; i++)
 	{
@@ -566,22 +738,22 @@ void desenharMapa(GLuint shaderID, float x0, float y0)
 		{
 			mat4 model = mat4(1);
 
-			Tile curr_tile = tileset[tileAt(i, j)];
-			if (i == player_i && j == player_j)
-				curr_tile = tileset[6];
+			// Tile 6 destaca a posição do jogador
+			bool jogadorAqui = i == jogo->estado().player_i && j == jogo->estado().player_j;
+			const Tile &curr_tile = tileset[jogadorAqui ? 6 : tileAt(i, j)];
 
 			float x = x0 + (j - i) * curr_tile.dimensions.x / 2.0f;
 			float y = y0 + (j + i) * curr_tile.dimensions.y / 2.0f;
 
 			model = translate(model, vec3(x, y, 0.0));
 			model = scale(model, curr_tile.dimensions);
-			glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+			programa.setMat4(uModel, value_ptr(model));
 
 			vec2 offsetTex;
 
-			offsetTex.s = curr_tile.iTile * curr_tile.ds;
-			offsetTex.t = 0.0;
-			glUniform2f(glGetUniformLocation(shaderID, "offsetTex"), offsetTex.s, offsetTex.t);
+			offsetTex.s = curr_tile.s0 + curr_tile.iTile * curr_tile.ds;
+			offsetTex.t = curr_tile.t0;
+			programa.setVec2(uOffsetTex, offsetTex.s, offsetTex.t);
 
 			glBindVertexArray(curr_tile.VAO);
 			glBindTexture(GL_TEXTURE_2D, curr_tile.texID);
@@ -591,65 +763,20 @@ void desenharMapa(GLuint shaderID, float x0, float y0)
 	}
 }
 
-// Função para inicializar as moedas no jogo
-void inicializarMoedas(GLuint texCoin)
-{
-	moedas.clear();
-
-	const int MAX_MOEDAS = 15;
-	int moedasCriadas = 0;
-
-	float chanceMoedaPorTile = 0.1f;
-
-	for (int i = 0; i < cfg.rows; ++i)
-	{
-		for (int j = 0; j < cfg.cols; ++j)
-		{
-
-			if (moedasCriadas >= MAX_MOEDAS)
-			{
-				break;
-			}
-
-			int tileID = tileAt(i, j);
-
-			if (tileset[tileID].type == TileType::Walkable &&
-				!(i == cfg.playerInicialRow && j == cfg.playerInicialCol))
-			{
-				float randomValue = (float)(rand()) / (float)(RAND_MAX);
-
-				if (randomValue < chanceMoedaPorTile)
-				{
-					moedas.push_back({i, j, false, texCoin});
-					moedasCriadas++;
-				}
-			}
-		}
-		if (moedasCriadas >= MAX_MOEDAS)
-		{
-			break;
-		}
-	}
-	totalMoedas = moedas.size();
-}
-
-void desenharMoedas(GLuint shaderID, float x0, float y0, const vector<Coin> &moedas)
+void desenharMoedas(ShaderProgram &programa, float x0, float y0, const vector<Moeda> &moedas)
 {
 	// Define tamanho e outras propriedades da moeda
 	vec3 dimensoesMoeda = vec3(cfg.tileW * 0.4f, cfg.tileH * 0.9f, 1.0f);
-	float ds = 1.0;
-	float dt = 1.0;
 
-	static GLuint coinVAO = setupSprite(1, 1, ds, dt); // Uma sprite estática (1x1)
-
-	glBindVertexArray(coinVAO);
+	glBindVertexArray(spriteMoeda.VAO);
+	// Todas as moedas usam o mesmo retângulo do atlas
+	programa.setVec2(uOffsetTex, spriteMoeda.s0, spriteMoeda.t0);
+	glBindTexture(GL_TEXTURE_2D, spriteMoeda.texID);
 
+	// A lista só tem as moedas ainda não coletadas (ver Jogo.h)
 	for (const auto &moeda : moedas)
 	{
-		if (moeda.collected)
-			continue;
-
-		Tile curr_tile = tileset[tileAt(moeda.i, moeda.j)];
+		const Tile &curr_tile = tileset[tileAt(moeda.i, moeda.j)];
 
 		float x = x0 + (moeda.j - moeda.i) * curr_tile.dimensions.x / 2.0f;
 		float y = y0 + (moeda.j + moeda.i) * curr_tile.dimensions.y / 2.0f;
@@ -658,161 +785,9 @@ void desenharMoedas(GLuint shaderID, float x0, float y0, const vector<Coin> &moe
 		model = translate(model, vec3(x + curr_tile.dimensions.x / 2.0f, y + curr_tile.dimensions.y / 2.0f - dimensoesMoeda.y / 2.0f, 0.1f));
 		model = scale(model, dimensoesMoeda);
 
-		glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-
-		// Usando o canto superior esquerdo da textura da moeda
-		glUniform2f(glGetUniformLocation(shaderID, "offsetTex"), 0.0f, 1.0f - dt);
-
-		// IMPORTANTE: Vincula a textura da moeda!
-		glBindTexture(GL_TEXTURE_2D, moeda.texID);
+		programa.setMat4(uModel, value_ptr(model));
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 	}
 
 	glBindVertexArray(0);
 }
-
-bool loadMapConfig(const string &path, MapConfig &cfg, string &err)
-{
-	ifstream in(path);
-	if (!in)
-	{
-		err = "Não foi possível abrir o arquivo de configuração: " + path;
-		return false;
-	}
-
-	string line, section;
-	unordered_set<string> seen;
-	vector<int> matrixVals;
-
-	auto need = [&](const string &s)
-	{
-		if (!seen.count(s))
-		{
-			err = "Seção [" + s + "] ausente";
-			return false;
-		}
-		return true;
-	};
-
-	while (getline(in, line))
-	{
-		// remove espaços laterais
-		line.erase(0, line.find_first_not_of(" \t\r\n"));
-		line.erase(line.find_last_not_of(" \t\r\n") + 1);
-
-		if (line.empty())
-			continue;
-		if (line.front() == '[' && line.back() == ']')
-		{ // nova seção
-			section = line.substr(1, line.size() - 2);
-			seen.insert(section);
-			continue;
-		}
-
-		istringstream iss(line);
-		if (section == "file")
-			getline(iss, cfg.tilesetFile);
-		else if (section == "nTiles")
-			iss >> cfg.nTiles;
-		else if (section == "width")
-			iss >> cfg.tileW;
-		else if (section == "height")
-			iss >> cfg.tileH;
-		else if (section == "rows")
-			iss >> cfg.rows;
-		else if (section == "columns")
-			iss >> cfg.cols;
-		else if (section == "rowInicialPosition")
-			iss >> cfg.playerInicialRow;
-		else if (section == "columnInicialPosition")
-			iss >> cfg.playerInicialCol;
-		else if (section == "matrix")
-		{
-			int v;
-			while (iss >> v)
-				matrixVals.push_back(v);
-		}
-		else
-		{
-			err = "Seção [" + section + "] desconhecida";
-			return false;
-		}
-	}
-
-	if (!need("file") || !need("nTiles") || !need("width") || !need("height") ||
-		!need("rows") || !need("columns") || !need("matrix") ||
-		!need("rowInicialPosition") || !need("columnInicialPosition"))
-		return false;
-
-	if (cfg.rows <= 0 || cfg.cols <= 0)
-	{
-		err = "Rows/Columns inválidos";
-		return false;
-	}
-
-	if ((int)matrixVals.size() != cfg.rows * cfg.cols)
-	{
-		err = "Tamanho da matriz (" + to_string(matrixVals.size()) +
-			  ") difere de rows*columns (" +
-			  to_string(cfg.rows * cfg.cols) + ")";
-		return false;
-	}
-
-	cfg.matrix.swap(matrixVals);
-
-	if (cfg.playerInicialRow < 0 || cfg.playerInicialRow >= cfg.rows ||
-		cfg.playerInicialCol < 0 || cfg.playerInicialCol >= cfg.cols)
-	{
-		err = "Posição inicial fora da matriz";
-		return false;
-	}
-
-	return true;
-}
-
-bool loadTileProps(const string &filename, vector<TileType> &tileTypes)
-{
-	ifstream file(filename);
-	if (!file.is_open())
-	{
-		cerr << "Erro ao abrir o arquivo de propriedades dos tiles: " << filename << endl;
-		return false;
-	}
-	string line, currentSection;
-	unordered_map<std::string, TileType> sectionMap = {
-		{"walkable", TileType::Walkable},
-		{"deadly", TileType::Deadly},
-		{"blocked", TileType::Blocked},
-		{"coin", TileType::Coin}};
-
-	while (getline(file, line))
-	{
-		line.erase(0, line.find_first_not_of(" \t\r\n"));
-		line.erase(line.find_last_not_of(" \t\r\n") + 1);
-
-		if (line.empty() || line[0] == '#')
-			continue;
-		if (line.front() == '[' && line.back() == ']')
-		{
-			currentSection = line.substr(1, line.size() - 2);
-			for (auto &c : currentSection)
-				c = tolower(c);
-			continue;
-		}
-		if (sectionMap.count(currentSection))
-		{
-			TileType tipo = sectionMap[currentSection];
-			istringstream iss(line);
-			int tileID;
-			while (iss >> tileID)
-			{
-				if (tileID >= 0 && tileID < (int)tileTypes.size())
-					tileTypes[tileID] = tipo;
-				else
-					cerr << "ID de tile inválido no arquivo tileProps.txt: " << tileID << endl;
-			}
-		}
-	}
-
-	return true;
-}
\ No newline at end of file